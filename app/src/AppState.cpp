@@ -1,10 +1,14 @@
 #include "AppState.h"
 
 #include <ctime>
+#include <utility>
 
 #include "pathcore/AStar.h"
+#include "pathcore/AnytimeAStar.h"
+#include "pathcore/BidirectionalDijkstra.h"
 #include "pathcore/Dijkstra.h"
 #include "pathcore/MapIO.h"
+#include "pathcore/PathDatabase.h"
 
 namespace {
 bool threadCpuTimeNs(std::uint64_t* out) {
@@ -37,6 +41,9 @@ int AppState::gridHeight() const {
 }
 
 const pathcore::SearchSnapshot* AppState::snapshot() const {
+    if (replaying_) {
+        return &replaySnapshot_;
+    }
     if (!search_) {
         return nullptr;
     }
@@ -106,12 +113,64 @@ double AppState::algoTimeMs() const {
     return static_cast<double>(algoTimeNs_) / 1e6;
 }
 
+double AppState::pathBound() const {
+    if (!search_) {
+        return 1.0;
+    }
+    return search_->path().bound;
+}
+
+bool AppState::showDistanceField() const {
+    return showDistanceField_;
+}
+
+const pathcore::DistanceField* AppState::distanceField() const {
+    if (!showDistanceField_ || !distanceField_.valid()) {
+        return nullptr;
+    }
+    return &distanceField_;
+}
+
+AppState::HeatmapMode AppState::heatmap() const {
+    return heatmap_;
+}
+
+const pathcore::SearchProfile* AppState::profile() const {
+    if (heatmap_ == HeatmapMode::States || !profile_.valid()) {
+        return nullptr;
+    }
+    return &profile_;
+}
+
+bool AppState::recording() const {
+    return recording_;
+}
+
+std::uint64_t AppState::replayFirstStep() const {
+    return recorder_.firstStep();
+}
+
+std::uint64_t AppState::replayStepCount() const {
+    return recorder_.stepCount();
+}
+
+bool AppState::replaying() const {
+    return replaying_;
+}
+
+std::uint64_t AppState::replayStep() const {
+    return replaying_ ? replayStep_ : recorder_.stepCount();
+}
+
 void AppState::setAlgorithm(AlgorithmKind kind) {
     if (algorithm_ == kind) {
         return;
     }
     algorithm_ = kind;
-    search_.reset();
+    if (search_) {
+        search_->setWorkspace(nullptr);
+        search_ = nullptr;
+    }
     resetSearch();
 }
 
@@ -181,6 +240,55 @@ void AppState::setTurnPenalty(int value) {
     resetSearch();
 }
 
+void AppState::setShowDistanceField(bool enabled) {
+    if (showDistanceField_ == enabled) {
+        return;
+    }
+    showDistanceField_ = enabled;
+    if (enabled) {
+        refreshDistanceField();
+    } else {
+        distanceField_.clear();
+    }
+}
+
+void AppState::setHeatmap(HeatmapMode mode) {
+    heatmap_ = mode;
+}
+
+void AppState::setRecording(bool enabled) {
+    if (recording_ == enabled) {
+        return;
+    }
+    recording_ = enabled;
+    if (search_) {
+        search_->setRecorder(enabled ? &recorder_ : nullptr);
+    }
+    if (!enabled) {
+        recorder_.clear();
+    }
+    resetSearch();
+}
+
+// The last step is the live search itself, so scrubbing to the end just shows it again.
+bool AppState::showReplayStep(std::uint64_t step) {
+    pause();
+    if (step >= recorder_.stepCount()) {
+        showLive();
+        return true;
+    }
+    if (!recorder_.reconstruct(step, &replaySnapshot_)) {
+        return false;
+    }
+    replaying_ = true;
+    replayStep_ = step;
+    return true;
+}
+
+void AppState::showLive() {
+    replaying_ = false;
+}
+
 void AppState::setStepsPerTick(int v) {
     if (v < 1) {
         v = 1;
@@ -198,10 +306,15 @@ void AppState::togglePlay() {
         playing_ = false;
         return;
     }
+    // The search has not been reset for the pending edits yet; commitEdits() does that.
+    if (editsPending_) {
+        return;
+    }
     if (!search_) {
         resetSearch();
     }
     if (search_ && search_->status() == pathcore::SearchStatus::Running) {
+        showLive();
         playing_ = true;
     }
 }
@@ -211,6 +324,10 @@ void AppState::pause() {
 }
 
 void AppState::stepOnce() {
+    if (editsPending_) {
+        return;
+    }
+    showLive();
     if (!search_) {
         resetSearch();
     }
@@ -228,11 +345,14 @@ void AppState::stepOnce() {
 }
 
 void AppState::resetSearch() {
+    showLive();
     createSearchIfNeeded();
     algoTimeNs_ = 0;
     if (!search_) {
         return;
     }
+    refreshComponents();
+    refreshDistanceField();
     search_->reset(grid_, start_, goal_, config_);
     playing_ = false;
 }
@@ -248,8 +368,13 @@ bool AppState::applyWallAt(pathcore::CellPos p, bool blocked) {
         return false;
     }
     grid_.setBlocked(p, blocked);
-    pause();
-    resetSearch();
+    if (blocked) {
+        components_.onCellBlocked(grid_, p);
+    } else {
+        components_.onCellOpened(grid_, p);
+    }
+    cellEdited(p);
+    searchInputsChanged();
     return true;
 }
 
@@ -263,11 +388,12 @@ bool AppState::applyCostAt(pathcore::CellPos p, int cost) {
     if (!grid_.setCost(p, cost)) {
         return false;
     }
+    components_.onCostChanged(grid_);
+    cellEdited(p);
     if (!config_.useWeights) {
         config_.useWeights = true;
     }
-    pause();
-    resetSearch();
+    searchInputsChanged();
     return true;
 }
 
@@ -282,6 +408,8 @@ bool AppState::setStartAt(pathcore::CellPos p) {
     bool changed = false;
     if (grid_.isBlocked(p)) {
         grid_.setBlocked(p, false);
+        components_.onCellOpened(grid_, p);
+        cellEdited(p);
         changed = true;
     }
     if (start_ != p) {
@@ -289,8 +417,7 @@ bool AppState::setStartAt(pathcore::CellPos p) {
         changed = true;
     }
     if (changed) {
-        pause();
-        resetSearch();
+        searchInputsChanged();
     }
     return changed;
 }
@@ -303,26 +430,58 @@ bool AppState::setGoalAt(pathcore::CellPos p) {
         return false;
     }
 
-    bool changed = false;
+    bool gridChanged = false;
     if (grid_.isBlocked(p)) {
         grid_.setBlocked(p, false);
-        changed = true;
+        components_.onCellOpened(grid_, p);
+        cellEdited(p);
+        gridChanged = true;
     }
-    if (goal_ != p) {
-        goal_ = p;
-        changed = true;
+    if (!gridChanged && goal_ == p) {
+        return false;
     }
-    if (changed) {
-        pause();
-        resetSearch();
+    goal_ = p;
+    pause();
+    // With the map untouched the running search can keep its work (Dijkstra reuses its tree);
+    // engines refuse on their own once the grid version moved.
+    if (!editsPending_ && search_ && search_->retarget(goal_)) {
+        showLive();
+        algoTimeNs_ = 0;
+        refreshDistanceField();
+    } else {
+        searchInputsChanged();
     }
-    return changed;
+    return true;
+}
+
+void AppState::beginEdits() {
+    ++editDepth_;
+}
+
+bool AppState::commitEdits() {
+    if (editDepth_ == 0 || --editDepth_ > 0) {
+        return false;
+    }
+    if (!editedCells_.empty()) {
+        distanceField_.update(grid_, editedCells_);
+        editedCells_.clear();
+    }
+    if (!editsPending_) {
+        return false;
+    }
+    editsPending_ = false;
+    resetSearch();
+    return true;
+}
+
+bool AppState::editing() const {
+    return editDepth_ > 0;
 }
 
 void AppState::clearWalls() {
-    grid_.clearBlocked();
-    grid_.fillCost(1);
+    grid_.fillRect(pathcore::CellPos{0, 0}, grid_.width(), grid_.height(), pathcore::Cell{});
     config_.useWeights = false;
+    invalidateCaches();
     pause();
     resetSearch();
 }
@@ -372,12 +531,44 @@ bool AppState::loadMap(const std::string& path, std::string* err) {
         }
     }
     config_.useWeights = hasWeights;
+    invalidateCaches();
+    artifacts_.setDirectory(pathcore::ArtifactStore::directoryForMap(path));
+    artifactVersion_ = grid_.version();
 
     pause();
     resetSearch();
     return true;
 }
 
+bool AppState::loadPathDatabase(const std::string& path, std::string* err) {
+    auto database = std::make_unique<pathcore::PathDatabase>();
+    pathcore::PathDatabaseError dbErr;
+    if (!database->open(path, &dbErr)) {
+        if (err) {
+            *err = dbErr.message;
+        }
+        return false;
+    }
+    if (!database->matches(grid_, config_)) {
+        if (err) {
+            *err = "Path database was built for a different map or settings.";
+        }
+        return false;
+    }
+
+    pathDatabasePath_ = path;
+    algorithm_ = AlgorithmKind::PathDatabase;
+    std::unique_ptr<pathcore::ISearch>& engine = engines_[static_cast<std::size_t>(AlgorithmKind::PathDatabase)];
+    if (search_) {
+        search_->setWorkspace(nullptr);
+    }
+    engine = std::move(database);
+    activateSearch(*engine);
+    pause();
+    resetSearch();
+    return true;
+}
+
 void AppState::replaceWorld(const pathcore::Grid& grid,
     pathcore::CellPos start,
     pathcore::CellPos goal,
@@ -394,14 +585,14 @@ void AppState::replaceWorld(const pathcore::Grid& grid,
     }
 
     config_.useWeights = useWeights;
+    invalidateCaches();
 
     pause();
     resetSearch();
 }
 
 void AppState::newMap() {
-    grid_.clearBlocked();
-    grid_.fillCost(1);
+    grid_.fillRect(pathcore::CellPos{0, 0}, grid_.width(), grid_.height(), pathcore::Cell{});
     config_.useWeights = false;
 
     const int width = grid_.width();
@@ -436,6 +627,7 @@ void AppState::newMap() {
     }
 
     paintCost_ = 5;
+    invalidateCaches();
     pause();
     resetSearch();
 }
@@ -485,11 +677,37 @@ bool AppState::resizeGrid(int width, int height) {
     }
 
     paintCost_ = 5;
+    invalidateCaches();
     pause();
     resetSearch();
     return true;
 }
 
+// Drops everything derived from the grid contents; used when the whole map changes.
+void AppState::invalidateCaches() {
+    components_.invalidate();
+    distanceField_.clear();
+    editedCells_.clear();
+}
+
+// The distance field is repaired right away, or for all cells at once by commitEdits().
+void AppState::cellEdited(pathcore::CellPos p) {
+    if (editDepth_ > 0) {
+        editedCells_.push_back(p);
+    } else {
+        distanceField_.update(grid_, {p});
+    }
+}
+
+void AppState::searchInputsChanged() {
+    pause();
+    if (editDepth_ > 0) {
+        editsPending_ = true;
+        return;
+    }
+    resetSearch();
+}
+
 void AppState::tick() {
     if (!playing_) {
         return;
@@ -569,12 +787,71 @@ void AppState::createSearchIfNeeded() {
     if (search_) {
         return;
     }
+    std::unique_ptr<pathcore::ISearch>& engine = engines_[static_cast<std::size_t>(algorithm_)];
+    if (engine) {
+        activateSearch(*engine);
+        return;
+    }
     switch (algorithm_) {
     case AlgorithmKind::Dijkstra:
-        search_ = std::make_unique<pathcore::Dijkstra>();
+        engine = std::make_unique<pathcore::Dijkstra>();
         break;
     case AlgorithmKind::AStar:
-        search_ = std::make_unique<pathcore::AStar>();
+        engine = std::make_unique<pathcore::AStar>();
+        break;
+    case AlgorithmKind::Anytime:
+        engine = std::make_unique<pathcore::AnytimeAStar>();
+        break;
+    case AlgorithmKind::Bidirectional:
+        engine = std::make_unique<pathcore::BidirectionalDijkstra>();
         break;
+    case AlgorithmKind::PathDatabase: {
+        // A file that fails to open leaves reset() failing, so the search shows NotStarted.
+        auto database = std::make_unique<pathcore::PathDatabase>();
+        database->open(pathDatabasePath_);
+        engine = std::move(database);
+        break;
+    }
+    }
+    activateSearch(*engine);
+}
+
+// The previous engine gave the workspace back when it was switched away from.
+void AppState::activateSearch(pathcore::ISearch& engine) {
+    engine.setComponentLabels(&components_);
+    engine.setWorkspace(&workspace_);
+    engine.setRecorder(recording_ ? &recorder_ : nullptr);
+    engine.setProfile(&profile_);
+    search_ = &engine;
+}
+
+// Edits keep the labels up to date cell by cell; only whole-map changes and split checks that
+// outgrow their budget pay for a full relabel. Relabels first look in the map's sidecar cache,
+// and labels built for the map as loaded are written there for the next start.
+void AppState::refreshComponents() {
+    const pathcore::Connectivity connectivity = pathcore::connectivityFor(config_);
+    if (!components_.matches(grid_, connectivity) || components_.needsRebuild()) {
+        const pathcore::ArtifactKey key = pathcore::ComponentLabels::artifactKey(connectivity);
+        const auto artifact = artifacts_.enabled() ? artifacts_.load(grid_, key) : nullptr;
+        if (artifact && components_.loadArtifact(grid_, connectivity, *artifact)) {
+            return;
+        }
+        components_.build(grid_, connectivity);
+        std::vector<std::uint8_t> payload;
+        if (artifacts_.enabled() && grid_.version() == artifactVersion_ && components_.writeArtifact(payload)) {
+            artifacts_.store(grid_, key, payload);
+        }
+    }
+}
+
+// Rebuilt when the goal or the move rules change; wall and cost edits are patched in place by
+// DistanceField::update().
+void AppState::refreshDistanceField() {
+    if (!showDistanceField_) {
+        return;
+    }
+    const bool sameGoal = distanceField_.goals().size() == 1 && distanceField_.goals().front() == goal_;
+    if (!distanceField_.matches(grid_, config_) || !sameGoal) {
+        distanceField_.build(grid_, config_, {goal_});
     }
 }
@@ -1,22 +1,35 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "pathcore/ArtifactStore.h"
+#include "pathcore/Components.h"
+#include "pathcore/DistanceField.h"
 #include "pathcore/Grid.h"
 #include "pathcore/ISearch.h"
 #include "pathcore/SearchConfig.h"
+#include "pathcore/SearchProfile.h"
+#include "pathcore/SearchRecorder.h"
 #include "pathcore/SearchSnapshot.h"
 #include "pathcore/SearchStatus.h"
+#include "pathcore/SearchWorkspace.h"
 #include "pathcore/Types.h"
 
 class AppState {
 public:
     enum class AlgorithmKind {
         Dijkstra,
-        AStar
+        AStar,
+        Anytime,
+        Bidirectional,
+        PathDatabase
     };
+    static constexpr std::size_t kAlgorithmCount = 5;
 
     enum class EditTool {
         DrawWall,
@@ -26,6 +39,16 @@ public:
         PaintCost
     };
 
+    // What GridView colors explored cells by: their node state, or one SearchProfile counter.
+    enum class HeatmapMode {
+        States,
+        ExpansionOrder,
+        Expansions,
+        Pushes,
+        StalePops,
+        Reopens
+    };
+
     AppState();
 
     const pathcore::Grid& grid() const;
@@ -47,6 +70,22 @@ public:
     int stepsPerTick() const;
     std::uint64_t algoTimeNs() const;
     double algoTimeMs() const;
+    // Suboptimality bound of the current path (1 when optimal or when there is none yet).
+    double pathBound() const;
+    bool showDistanceField() const;
+    // Distance/flow field towards the goal while it is shown, otherwise nullptr.
+    const pathcore::DistanceField* distanceField() const;
+    HeatmapMode heatmap() const;
+    // Per-cell counters of the current search while a heatmap is shown, otherwise nullptr.
+    const pathcore::SearchProfile* profile() const;
+    // While recording() is on (the default) every search is recorded; steps
+    // replayFirstStep()..replayStepCount() of it can be shown. While one is, snapshot() returns
+    // it instead of the live search, until showLive() or anything that runs or resets the search.
+    bool recording() const;
+    std::uint64_t replayFirstStep() const;
+    std::uint64_t replayStepCount() const;
+    bool replaying() const;
+    std::uint64_t replayStep() const;
 
     void setAlgorithm(AlgorithmKind kind);
     void setTool(EditTool tool);
@@ -56,6 +95,12 @@ public:
     void setCornerCutting(bool enabled);
     void setPenalizeTurns(bool enabled);
     void setTurnPenalty(int value);
+    void setShowDistanceField(bool enabled);
+    void setHeatmap(HeatmapMode mode);
+    // Restarts the search so the recording covers it from the start; off drops the recording.
+    void setRecording(bool enabled);
+    bool showReplayStep(std::uint64_t step);
+    void showLive();
     void togglePlay();
     void pause();
     void stepOnce();
@@ -65,6 +110,8 @@ public:
 
     bool saveMap(const std::string& path, std::string* err = nullptr) const;
     bool loadMap(const std::string& path, std::string* err = nullptr);
+    // Switches to answering queries from a prebuilt path database (see pathdb_build).
+    bool loadPathDatabase(const std::string& path, std::string* err = nullptr);
     void replaceWorld(const pathcore::Grid& grid,
         pathcore::CellPos start,
         pathcore::CellPos goal,
@@ -72,6 +119,14 @@ public:
     void newMap();
     bool resizeGrid(int width, int height);
 
+    // Groups edits such as one mouse drag: until the matching commitEdits() the edit calls
+    // below only change the grid (and the component labels); the distance field repair and
+    // search reset run once at commit, and play/step are ignored while that reset is pending.
+    // Returns true from commit when anything changed.
+    void beginEdits();
+    bool commitEdits();
+    bool editing() const;
+
     bool applyWallAt(pathcore::CellPos p, bool blocked);
     bool applyCostAt(pathcore::CellPos p, int cost);
     bool setStartAt(pathcore::CellPos p);
@@ -81,6 +136,12 @@ public:
 private:
     void buildHardcodedMap();
     void createSearchIfNeeded();
+    void activateSearch(pathcore::ISearch& engine);
+    void refreshComponents();
+    void refreshDistanceField();
+    void invalidateCaches();
+    void cellEdited(pathcore::CellPos p);
+    void searchInputsChanged();
 
     pathcore::Grid grid_;
     pathcore::CellPos start_{};
@@ -88,9 +149,32 @@ private:
     pathcore::SearchConfig config_{};
     AlgorithmKind algorithm_{AlgorithmKind::Dijkstra};
     EditTool tool_{EditTool::DrawWall};
-    std::unique_ptr<pathcore::ISearch> search_;
+    // Declared before search_ so they outlive the engine borrowing them.
+    pathcore::SearchWorkspace workspace_;
+    pathcore::SearchRecorder recorder_;
+    pathcore::SearchProfile profile_;
+    // One engine per AlgorithmKind, built on first use and kept, so switching back and forth
+    // allocates nothing; search_ is the current one and holds the workspace.
+    std::array<std::unique_ptr<pathcore::ISearch>, kAlgorithmCount> engines_;
+    pathcore::ISearch* search_{nullptr};
+    pathcore::ComponentLabels components_;
+    // Sidecar directory of the last loaded map; labels are written back only while the grid
+    // is still what was loaded (artifactVersion_).
+    pathcore::ArtifactStore artifacts_;
+    std::uint64_t artifactVersion_{0};
+    std::string pathDatabasePath_;
+    pathcore::DistanceField distanceField_;
+    bool showDistanceField_{false};
+    HeatmapMode heatmap_{HeatmapMode::States};
     bool playing_{false};
     int stepsPerTick_{5};
     int paintCost_{5};
     std::uint64_t algoTimeNs_{0};
+    int editDepth_{0};
+    bool editsPending_{false};
+    std::vector<pathcore::CellPos> editedCells_;
+    bool recording_{true};
+    bool replaying_{false};
+    std::uint64_t replayStep_{0};
+    pathcore::SearchSnapshot replaySnapshot_;
 };
@@ -1,16 +1,21 @@
 #include "GridView.h"
 
 #include <cmath>
+#include <cstdint>
 #include <utility>
 #include <QPainter>
 
 #include "AppState.h"
+#include "pathcore/DistanceField.h"
 #include "pathcore/NodeState.h"
+#include "pathcore/SearchProfile.h"
+#include "pathcore/SearchSnapshot.h"
 
 GridView::GridView(QWidget* parent)
     : QWidget(parent) {}
 
 void GridView::setAppState(AppState* state) {
+    finishDrag();
     state_ = state;
     update();
 }
@@ -104,12 +109,32 @@ bool GridView::applyToolAt(pathcore::CellPos cell, Qt::MouseButton button) {
         break;
     }
 
-    if (changed && onEdited_) {
+    if (dragging_) {
+        dragChanged_ = dragChanged_ || changed;
+    } else if (changed && onEdited_) {
         onEdited_();
     }
     return changed;
 }
 
+// Commits the drag's edits: one search reset and one edited callback for the whole stroke.
+void GridView::finishDrag() {
+    if (!dragging_) {
+        return;
+    }
+    dragging_ = false;
+    if (state_) {
+        state_->commitEdits();
+    }
+    if (dragChanged_) {
+        dragChanged_ = false;
+        update();
+        if (onEdited_) {
+            onEdited_();
+        }
+    }
+}
+
 void GridView::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
 
@@ -161,6 +186,55 @@ void GridView::paintEvent(QPaintEvent* event) {
         return QColor(value, value, value);
     };
 
+    // Near cells are warm, far ones cool; cells that cannot reach the goal stay grey.
+    const pathcore::DistanceField* field = state_->distanceField();
+    const std::int32_t fieldMax = field ? field->maxDistance() : 0;
+    auto fieldShade = [fieldMax](std::int32_t distance) {
+        if (distance == pathcore::SearchSnapshot::kInfScore) {
+            return QColor(203, 213, 225);
+        }
+        const qreal t = fieldMax > 0 ? static_cast<qreal>(distance) / fieldMax : 0.0;
+        const QColor nearColor(254, 240, 138);
+        const QColor farColor(30, 64, 175);
+        return QColor::fromRgbF(nearColor.redF() + (farColor.redF() - nearColor.redF()) * t,
+            nearColor.greenF() + (farColor.greenF() - nearColor.greenF()) * t,
+            nearColor.blueF() + (farColor.blueF() - nearColor.blueF()) * t);
+    };
+
+    // Counter heatmap: pale for the smallest values, dark red for the largest.
+    const pathcore::SearchProfile* profile = state_->profile();
+    pathcore::ProfileCounter counter = pathcore::ProfileCounter::Expansions;
+    switch (state_->heatmap()) {
+    case AppState::HeatmapMode::ExpansionOrder:
+        counter = pathcore::ProfileCounter::ExpansionOrder;
+        break;
+    case AppState::HeatmapMode::Pushes:
+        counter = pathcore::ProfileCounter::Pushes;
+        break;
+    case AppState::HeatmapMode::StalePops:
+        counter = pathcore::ProfileCounter::StalePops;
+        break;
+    case AppState::HeatmapMode::Reopens:
+        counter = pathcore::ProfileCounter::Reopens;
+        break;
+    case AppState::HeatmapMode::States:
+    case AppState::HeatmapMode::Expansions:
+    default:
+        break;
+    }
+    // Expansion order starts at 0 and has -1 for cells never expanded; counts start at 1.
+    const bool orderHeatmap = counter == pathcore::ProfileCounter::ExpansionOrder;
+    const std::int64_t heatMin = orderHeatmap ? 0 : 1;
+    const std::int64_t heatMax = profile ? profile->maxValue(counter) : 0;
+    auto heatShade = [heatMin, heatMax](std::int64_t value) {
+        const qreal t = heatMax > heatMin ? static_cast<qreal>(value - heatMin) / (heatMax - heatMin) : 1.0;
+        const QColor lowColor(254, 243, 199);
+        const QColor highColor(153, 27, 27);
+        return QColor::fromRgbF(lowColor.redF() + (highColor.redF() - lowColor.redF()) * t,
+            lowColor.greenF() + (highColor.greenF() - lowColor.greenF()) * t,
+            lowColor.blueF() + (highColor.blueF() - lowColor.blueF()) * t);
+    };
+
     const bool showCosts = state_->useWeights();
     const bool drawGridLines = cellSize >= 6.0;
     if (drawGridLines) {
@@ -179,7 +253,12 @@ void GridView::paintEvent(QPaintEvent* event) {
             } else {
                 const pathcore::NodeState state =
                     snapshotValid ? snapshot->getState(pos) : pathcore::NodeState::Unseen;
-                if (snapshotValid && state != pathcore::NodeState::Unseen) {
+                const std::int64_t heat = profile ? profile->value(counter, pos) : 0;
+                if (profile && state != pathcore::NodeState::Path && heat >= heatMin) {
+                    cellColor = heatShade(heat);
+                } else if (field && state != pathcore::NodeState::Path) {
+                    cellColor = fieldShade(field->distance(pos));
+                } else if (snapshotValid && state != pathcore::NodeState::Unseen) {
                     switch (state) {
                     case pathcore::NodeState::Path:
                         cellColor = pathColor;
@@ -224,6 +303,10 @@ void GridView::mousePressEvent(QMouseEvent* event) {
     if (!interactive_) {
         return;
     }
+    if (state_ && event->button() == Qt::LeftButton && !dragging_) {
+        state_->beginEdits();
+        dragging_ = true;
+    }
     const auto cell = cellFromMousePos(event->pos());
     if (!cell) {
         return;
@@ -253,5 +336,8 @@ void GridView::mouseMoveEvent(QMouseEvent* event) {
 }
 
 void GridView::mouseReleaseEvent(QMouseEvent* event) {
-    Q_UNUSED(event);
+    if (!event || event->button() != Qt::LeftButton) {
+        return;
+    }
+    finishDrag();
 }
@@ -36,8 +36,12 @@ private:
     std::optional<GridLayout> computeLayout() const;
     std::optional<pathcore::CellPos> cellFromMousePos(const QPoint& pos) const;
     bool applyToolAt(pathcore::CellPos cell, Qt::MouseButton button);
+    void finishDrag();
 
     AppState* state_{nullptr};
     bool interactive_{true};
+    // A left-button drag is one AppState edit transaction.
+    bool dragging_{false};
+    bool dragChanged_{false};
     std::function<void()> onEdited_{};
 };
@@ -1,8 +1,11 @@
 #include "MainWindow.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <QAction>
 #include <QActionGroup>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDialog>
 #include <QDialogButtonBox>
@@ -15,6 +18,7 @@
 #include <QMessageBox>
 #include <QSignalBlocker>
 #include <QSizePolicy>
+#include <QSlider>
 #include <QSpinBox>
 #include <QStackedWidget>
 #include <QStatusBar>
@@ -70,12 +74,26 @@ QString statusText(pathcore::SearchStatus status) {
         return "Found";
     case pathcore::SearchStatus::NoPath:
         return "NoPath";
+    case pathcore::SearchStatus::Cancelled:
+        return "Cancelled";
     }
     return "Unknown";
 }
 
 QString algorithmText(AppState::AlgorithmKind kind) {
-    return kind == AppState::AlgorithmKind::AStar ? "A*" : "Dijkstra";
+    switch (kind) {
+    case AppState::AlgorithmKind::Dijkstra:
+        return "Dijkstra";
+    case AppState::AlgorithmKind::AStar:
+        return "A*";
+    case AppState::AlgorithmKind::Anytime:
+        return "ARA*";
+    case AppState::AlgorithmKind::Bidirectional:
+        return "Bidir";
+    case AppState::AlgorithmKind::PathDatabase:
+        return "PathDB";
+    }
+    return "Unknown";
 }
 } // namespace
 
@@ -100,13 +118,47 @@ MainWindow::MainWindow(const LaunchOptions& opts, QWidget* parent)
     if (options_.mode == AppMode::Single) {
         appState_.setAlgorithm(toAppAlgorithm(options_.singleAlgo));
     } else {
+        // Versus mode has no timeline to replay them on.
+        leftState_.setRecording(false);
+        rightState_.setRecording(false);
         leftState_.setAlgorithm(toAppAlgorithm(options_.leftAlgo));
         rightState_.setAlgorithm(toAppAlgorithm(options_.rightAlgo));
     }
 
     QStackedWidget* centralStack = new QStackedWidget(this);
-    gridView_ = new GridView(centralStack);
+    QWidget* singleView = new QWidget(centralStack);
+    QVBoxLayout* singleLayout = new QVBoxLayout(singleView);
+    singleLayout->setContentsMargins(0, 0, 0, 0);
+    singleLayout->setSpacing(0);
+    gridView_ = new GridView(singleView);
     gridView_->setAppState(&appState_);
+    singleLayout->addWidget(gridView_, 1);
+
+    // Scrubs through the recording of the current search; the right end is the live search.
+    QHBoxLayout* timelineLayout = new QHBoxLayout();
+    timelineLayout->setContentsMargins(8, 4, 8, 4);
+    timelineSlider_ = new QSlider(Qt::Horizontal, singleView);
+    timelineLabel_ = new QLabel(singleView);
+    timelineLabel_->setMinimumWidth(120);
+    recordCheck_ = new QCheckBox("Record", singleView);
+    recordCheck_->setChecked(appState_.recording());
+    timelineLayout->addWidget(recordCheck_);
+    timelineLayout->addWidget(new QLabel("Step", singleView));
+    timelineLayout->addWidget(timelineSlider_, 1);
+    timelineLayout->addWidget(timelineLabel_);
+    singleLayout->addLayout(timelineLayout);
+    connect(recordCheck_, &QCheckBox::toggled, this, [this](bool checked) {
+        appState_.setRecording(checked);
+        gridView_->update();
+        updatePlayAction();
+        updateStatusBar();
+    });
+    connect(timelineSlider_, &QSlider::valueChanged, this, [this](int value) {
+        appState_.showReplayStep(static_cast<std::uint64_t>(value));
+        gridView_->update();
+        updatePlayAction();
+        updateStatusBar();
+    });
 
     versusView_ = new VersusView(centralStack);
     versusView_->setStates(&leftState_, &rightState_);
@@ -114,10 +166,9 @@ MainWindow::MainWindow(const LaunchOptions& opts, QWidget* parent)
     versusView_->rightGrid()->setInteractive(false);
     versusView_->leftGrid()->setEditedCallback([this]() { syncRightFromLeft(); });
 
-    centralStack->addWidget(gridView_);
+    centralStack->addWidget(singleView);
     centralStack->addWidget(versusView_);
-    centralStack->setCurrentWidget(isVersus() ? static_cast<QWidget*>(versusView_)
-                                              : static_cast<QWidget*>(gridView_));
+    centralStack->setCurrentWidget(isVersus() ? static_cast<QWidget*>(versusView_) : singleView);
     setCentralWidget(centralStack);
 
     if (isVersus()) {
@@ -161,13 +212,36 @@ MainWindow::MainWindow(const LaunchOptions& opts, QWidget* parent)
     aStarAction_ = toolbar->addAction("A*");
     aStarAction_->setCheckable(true);
     aStarAction_->setShortcut(QKeySequence(Qt::Key_2));
+    anytimeAction_ = toolbar->addAction("ARA*");
+    anytimeAction_->setCheckable(true);
+    anytimeAction_->setShortcut(QKeySequence(Qt::Key_3));
+    bidirAction_ = toolbar->addAction("Bidir");
+    bidirAction_->setCheckable(true);
+    bidirAction_->setShortcut(QKeySequence(Qt::Key_4));
+    pathDbAction_ = toolbar->addAction("PathDB");
+    pathDbAction_->setCheckable(true);
 
     algorithmGroup->addAction(dijkstraAction_);
     algorithmGroup->addAction(aStarAction_);
-    if (controlState.algorithm() == AppState::AlgorithmKind::Dijkstra) {
+    algorithmGroup->addAction(anytimeAction_);
+    algorithmGroup->addAction(bidirAction_);
+    algorithmGroup->addAction(pathDbAction_);
+    switch (controlState.algorithm()) {
+    case AppState::AlgorithmKind::Dijkstra:
         dijkstraAction_->setChecked(true);
-    } else {
+        break;
+    case AppState::AlgorithmKind::AStar:
         aStarAction_->setChecked(true);
+        break;
+    case AppState::AlgorithmKind::Anytime:
+        anytimeAction_->setChecked(true);
+        break;
+    case AppState::AlgorithmKind::Bidirectional:
+        bidirAction_->setChecked(true);
+        break;
+    case AppState::AlgorithmKind::PathDatabase:
+        pathDbAction_->setChecked(true);
+        break;
     }
 
     if (isVersus()) {
@@ -175,6 +249,12 @@ MainWindow::MainWindow(const LaunchOptions& opts, QWidget* parent)
         dijkstraAction_->setEnabled(false);
         aStarAction_->setVisible(false);
         aStarAction_->setEnabled(false);
+        anytimeAction_->setVisible(false);
+        anytimeAction_->setEnabled(false);
+        bidirAction_->setVisible(false);
+        bidirAction_->setEnabled(false);
+        pathDbAction_->setVisible(false);
+        pathDbAction_->setEnabled(false);
     }
 
     toolbar->addSeparator();
@@ -212,6 +292,18 @@ MainWindow::MainWindow(const LaunchOptions& opts, QWidget* parent)
         QWidgetAction* turnPenaltySpinAction = new QWidgetAction(toolbar);
         turnPenaltySpinAction->setDefaultWidget(turnPenaltySpin_);
         toolbar->addAction(turnPenaltySpinAction);
+
+        fieldAction_ = toolbar->addAction("Field");
+        fieldAction_->setCheckable(true);
+        fieldAction_->setShortcut(QKeySequence(Qt::Key_F));
+        fieldAction_->setChecked(controlState.showDistanceField());
+
+        // Item order follows AppState::HeatmapMode.
+        heatmapCombo_ = new QComboBox(toolbar);
+        heatmapCombo_->addItems({"States", "Expansion order", "Expansions", "Pushes", "Stale pops", "Reopens"});
+        heatmapCombo_->setCurrentIndex(static_cast<int>(controlState.heatmap()));
+        heatmapCombo_->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+        toolbar->addWidget(heatmapCombo_);
         toolbar->addSeparator();
     }
 
@@ -548,6 +640,44 @@ MainWindow::MainWindow(const LaunchOptions& opts, QWidget* parent)
             updatePlayAction();
             updateStatusBarCurrentMode();
         });
+
+        connect(anytimeAction_, &QAction::triggered, this, [this](bool) {
+            appState_.setAlgorithm(AppState::AlgorithmKind::Anytime);
+            updateViewsCurrentMode();
+            updatePlayAction();
+            updateStatusBarCurrentMode();
+        });
+
+        connect(bidirAction_, &QAction::triggered, this, [this](bool) {
+            appState_.setAlgorithm(AppState::AlgorithmKind::Bidirectional);
+            updateViewsCurrentMode();
+            updatePlayAction();
+            updateStatusBarCurrentMode();
+        });
+
+        connect(pathDbAction_, &QAction::triggered, this, [this](bool) {
+            const QString path = QFileDialog::getOpenFileName(
+                this, "Open Path Database", QString(), "PathViz Path Database (*.pathdb);;All Files (*)");
+            std::string err;
+            if (path.isEmpty() || !appState_.loadPathDatabase(path.toStdString(), &err)) {
+                if (!err.empty()) {
+                    QMessageBox::warning(this, "Open Path Database", QString::fromStdString(err));
+                }
+                if (appState_.algorithm() == AppState::AlgorithmKind::AStar) {
+                    aStarAction_->setChecked(true);
+                } else if (appState_.algorithm() == AppState::AlgorithmKind::Anytime) {
+                    anytimeAction_->setChecked(true);
+                } else if (appState_.algorithm() == AppState::AlgorithmKind::Bidirectional) {
+                    bidirAction_->setChecked(true);
+                } else if (appState_.algorithm() == AppState::AlgorithmKind::Dijkstra) {
+                    dijkstraAction_->setChecked(true);
+                }
+                return;
+            }
+            updateViewsCurrentMode();
+            updatePlayAction();
+            updateStatusBarCurrentMode();
+        });
     }
 
     auto updateTimerInterval = [this]() {
@@ -715,6 +845,17 @@ MainWindow::MainWindow(const LaunchOptions& opts, QWidget* parent)
                 updateStatusBarCurrentMode();
             });
 
+        connect(fieldAction_, &QAction::toggled, this, [this](bool checked) {
+            appState_.setShowDistanceField(checked);
+            updateViewsCurrentMode();
+        });
+
+        connect(heatmapCombo_, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this](int index) {
+                appState_.setHeatmap(static_cast<AppState::HeatmapMode>(index));
+                updateViewsCurrentMode();
+            });
+
         connect(speedSpin, QOverload<int>::of(&QSpinBox::valueChanged), this,
             [this, updateTimerInterval](int value) {
                 appState_.setStepsPerTick(value);
@@ -907,7 +1048,10 @@ void MainWindow::updateStatusBar() {
     }
 
     const QString statusLabel = statusText(appState_.status());
-    const QString algorithmLabel = algorithmText(appState_.algorithm());
+    QString algorithmLabel = algorithmText(appState_.algorithm());
+    if (appState_.algorithm() == AppState::AlgorithmKind::Anytime) {
+        algorithmLabel += QString(" (bound %1)").arg(appState_.pathBound(), 0, 'f', 2);
+    }
 
     QString toolText;
     switch (appState_.tool()) {
@@ -960,6 +1104,7 @@ void MainWindow::updateStatusBar() {
             .arg(timeText);
 
     statusBar()->showMessage(message);
+    updateTimeline();
 }
 
 void MainWindow::updateStatusBarVersus() {
@@ -1065,6 +1210,25 @@ void MainWindow::updateStatusBarVersus() {
     statusBar()->showMessage(message);
 }
 
+void MainWindow::updateTimeline() {
+    if (!timelineSlider_) {
+        return;
+    }
+    constexpr std::uint64_t kSliderMax = static_cast<std::uint64_t>(std::numeric_limits<int>::max());
+    const int first = static_cast<int>(std::min(appState_.replayFirstStep(), kSliderMax));
+    const int last = static_cast<int>(std::min(appState_.replayStepCount(), kSliderMax));
+    const int current = static_cast<int>(std::min(appState_.replayStep(), kSliderMax));
+    {
+        QSignalBlocker blocker(timelineSlider_);
+        timelineSlider_->setRange(first, last);
+        timelineSlider_->setPageStep(std::max(1, (last - first) / 20));
+        timelineSlider_->setValue(current);
+    }
+    timelineSlider_->setEnabled(last > first);
+    timelineLabel_->setText(appState_.replaying() ? QString("%1 / %2").arg(current).arg(last)
+                                                  : QString("%1 (live)").arg(last));
+}
+
 void MainWindow::updatePlayAction() {
     if (!playAction_) {
         return;
@@ -6,7 +6,11 @@
 #include "LaunchOptions.h"
 
 class QAction;
+class QCheckBox;
 class GridView;
+class QComboBox;
+class QLabel;
+class QSlider;
 class QSpinBox;
 class QTimer;
 class VersusView;
@@ -25,12 +29,16 @@ private:
     void updateStatusBarVersus();
     void updateStatusBar();
     void updatePlayAction();
+    void updateTimeline();
 
     LaunchOptions options_;
     AppState appState_;
     AppState leftState_;
     AppState rightState_;
     GridView* gridView_{nullptr};
+    QSlider* timelineSlider_{nullptr};
+    QLabel* timelineLabel_{nullptr};
+    QCheckBox* recordCheck_{nullptr};
     VersusView* versusView_{nullptr};
     QTimer* timer_{nullptr};
     QAction* playAction_{nullptr};
@@ -38,6 +46,8 @@ private:
     QAction* resetAction_{nullptr};
     QAction* weightsAction_{nullptr};
     QAction* turnPenaltyAction_{nullptr};
+    QAction* fieldAction_{nullptr};
+    QComboBox* heatmapCombo_{nullptr};
     QSpinBox* turnPenaltySpin_{nullptr};
     QAction* leftWeightsAction_{nullptr};
     QAction* rightWeightsAction_{nullptr};
@@ -53,4 +63,7 @@ private:
     QSpinBox* rightSpeedSpin_{nullptr};
     QAction* dijkstraAction_{nullptr};
     QAction* aStarAction_{nullptr};
+    QAction* anytimeAction_{nullptr};
+    QAction* bidirAction_{nullptr};
+    QAction* pathDbAction_{nullptr};
 };
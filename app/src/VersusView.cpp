@@ -21,12 +21,26 @@ QString statusText(pathcore::SearchStatus status) {
         return "Found";
     case pathcore::SearchStatus::NoPath:
         return "NoPath";
+    case pathcore::SearchStatus::Cancelled:
+        return "Cancelled";
     }
     return "Unknown";
 }
 
 QString algorithmText(AppState::AlgorithmKind kind) {
-    return kind == AppState::AlgorithmKind::AStar ? "A*" : "Dijkstra";
+    switch (kind) {
+    case AppState::AlgorithmKind::Dijkstra:
+        return "Dijkstra";
+    case AppState::AlgorithmKind::AStar:
+        return "A*";
+    case AppState::AlgorithmKind::Anytime:
+        return "ARA*";
+    case AppState::AlgorithmKind::Bidirectional:
+        return "Bidir";
+    case AppState::AlgorithmKind::PathDatabase:
+        return "PathDB";
+    }
+    return "Unknown";
 }
 } // namespace
 
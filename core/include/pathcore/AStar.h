@@ -2,46 +2,47 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <queue>
+#include <memory_resource>
 #include <vector>
 
-#include "pathcore/ISearch.h"
-#include "pathcore/SearchBase.h"
+#include "pathcore/HeuristicProvider.h"
 #include "pathcore/SearchConfig.h"
+#include "pathcore/SearchEngine.h"
 
 namespace pathcore {
 
-class AStar final : public ISearch, public SearchBase {
+class AStar final : public SearchEngine {
 public:
+    AStar() = default;
+    explicit AStar(std::pmr::memory_resource* upstream)
+        : SearchEngine(upstream) {
+    }
+
     bool reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) override;
     SearchStatus step(std::size_t iterations = 1) override;
-    SearchStatus status() const override {
-        return SearchBase::status();
-    }
-    const SearchSnapshot& snapshot() const override {
-        return SearchBase::snapshot();
-    }
 
-private:
-    struct QueueItem {
-        std::int32_t f;
-        std::int32_t g;
-        std::int32_t idx;
-    };
+    // Optional extra heuristic (e.g. LandmarkHeuristic), taken into account from the next reset.
+    void setHeuristicProvider(HeuristicProvider* provider);
 
+private:
+    // Open entries are keyed by f.
     struct QueueItemCompare {
-        bool operator()(const QueueItem& a, const QueueItem& b) const {
-            if (a.f != b.f) {
-                return a.f > b.f;
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const {
+            if (a.key != b.key) {
+                return a.key > b.key;
             }
             return a.g < b.g; // Tie-breaker: prefer larger g to reduce zig-zagging.
         }
     };
 
     static std::int32_t heuristic(CellPos a, CellPos b, NeighborMode mode);
-    void rebuildPath(std::int32_t startIdx, std::int32_t goalIdx);
+    std::int32_t estimate(CellPos p, std::int32_t slot) const;
+    void learnFromSearch(std::int32_t goalCost);
 
-    std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemCompare> open_;
+    HeuristicProvider* provider_{nullptr};
+    bool useProvider_{false};
+    // learnFromSearch scratch, kept for its capacity.
+    std::vector<HeuristicProvider::SettledCell> settled_;
 };
 
 } // namespace pathcore
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/HeuristicProvider.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+struct AdaptiveHeuristicStats {
+    std::uint64_t queries{0};
+    std::uint64_t exactHits{0};   // same goal as a cached entry
+    std::uint64_t regionHits{0};  // another goal of the same region, values shifted
+    std::uint64_t misses{0};
+    std::uint64_t learnedCells{0}; // cached estimates raised by learn()
+    std::uint64_t estimates{0};
+    std::uint64_t informedEstimates{0}; // estimates answered from learned values
+};
+
+// Adaptive A*: after each search every expanded cell s learns h(s) = cost(goal) - g(s), which
+// is admissible and consistent for that goal. Values are cached per goal region of
+// regionSize x regionSize cells; a query for another goal g' of the region reuses them shifted
+// down by an upper bound U on cost(g' -> g), since cost(s, g') >= cost(s, g) - cost(g', g).
+//
+// Like other precomputed heuristics the cache belongs to one grid: it is dropped when prepare()
+// sees a Grid::version other than the one it was learned on. Turn penalties make h depend on
+// the heading, so searches using them fall back to the built-in heuristic.
+class AdaptiveHeuristic final : public HeuristicProvider {
+public:
+    explicit AdaptiveHeuristic(int regionSize = 8, std::size_t maxEntries = 64);
+
+    void clear();
+    const AdaptiveHeuristicStats& stats() const;
+    void resetStats();
+
+    bool prepare(const Grid& grid, CellPos goal, const SearchConfig& config) override;
+    std::int32_t estimate(CellPos p, std::int32_t slot) const override;
+    bool wantsLearning() const override {
+        return true;
+    }
+    void learn(const Grid& grid, CellPos goal, std::int32_t goalCost,
+        const std::vector<SettledCell>& settled) override;
+
+private:
+    struct Entry {
+        CellPos goal{};
+        std::vector<std::int32_t> h; // by padded slot, -1 = nothing learned
+        std::uint64_t lastUsed{0};
+    };
+
+    Entry* findEntry(CellPos goal);
+    Entry& entryFor(CellPos goal);
+
+    int regionSize_;
+    std::size_t maxEntries_;
+    int width_{0};
+    int height_{0};
+    // Grid::version the cached values were learned on.
+    std::uint64_t gridVersion_{0};
+    IndexLayout layout_{IndexLayout::RowMajor};
+    SearchConfig config_{};
+    std::vector<Entry> entries_;
+    std::uint64_t clock_{0};
+
+    // Set by prepare() for the current search.
+    const Entry* active_{nullptr};
+    std::int32_t offset_{0};
+    CellPos preparedGoal_{};
+    mutable AdaptiveHeuristicStats stats_{};
+};
+
+} // namespace pathcore
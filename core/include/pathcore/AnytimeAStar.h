@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <set>
+#include <vector>
+
+#include "pathcore/SearchConfig.h"
+#include "pathcore/SearchEngine.h"
+
+namespace pathcore {
+
+enum class AnytimeVariant : std::uint8_t {
+    // ARA*: weighted A* passes with a shrinking weight; cells improved after being closed wait
+    // in INCONS and seed the next pass instead of being re-expanded.
+    Ara = 0,
+    // Focal search: expands the open cell closest to the goal among those with
+    // f <= weight * min f; later passes tighten the weight and prune by the incumbent cost.
+    // Works best on uniform-cost maps; with weights the step-count heuristic is too weak to
+    // keep the focal list small.
+    Focal
+};
+
+struct AnytimeOptions {
+    AnytimeVariant variant{AnytimeVariant::Ara};
+    double initialWeight{2.5};
+    double weightStep{0.5};
+    // Measured from reset(); once it passes, the best path found so far becomes final. The
+    // first path is always completed. Zero means no deadline.
+    std::chrono::steady_clock::duration deadline{};
+};
+
+// Bounded-suboptimal search that keeps improving its answer. While status() is Running,
+// path() may already hold a solution (marked in the snapshot too) whose SearchPath::bound
+// says how far from optimal it can be; every improvement replaces it. Found means the last
+// path is optimal or the deadline passed.
+class AnytimeAStar final : public SearchEngine {
+public:
+    explicit AnytimeAStar(const AnytimeOptions& options = {},
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    bool reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) override;
+    SearchStatus step(std::size_t iterations = 1) override;
+
+    // Taken into account from the next reset.
+    void setOptions(const AnytimeOptions& options);
+    const AnytimeOptions& options() const;
+    // Inflation of the pass in progress.
+    double weight() const;
+    int solutionCount() const;
+
+private:
+    struct QueueItem {
+        double key;
+        std::int32_t g;
+        std::int32_t idx;
+    };
+
+    struct QueueItemCompare {
+        bool operator()(const QueueItem& a, const QueueItem& b) const {
+            if (a.key != b.key) {
+                return a.key > b.key;
+            }
+            return a.g < b.g;
+        }
+    };
+
+    // Open cells by f (then larger g); focal cells by h (then f).
+    struct RankedCell {
+        std::int32_t primary;
+        std::int32_t secondary;
+        std::int32_t idx;
+
+        bool operator<(const RankedCell& o) const {
+            if (primary != o.primary) {
+                return primary < o.primary;
+            }
+            if (secondary != o.secondary) {
+                return secondary < o.secondary;
+            }
+            return idx < o.idx;
+        }
+    };
+
+    static std::int32_t heuristic(CellPos a, CellPos b, NeighborMode mode);
+    double araKey(std::int32_t idx) const;
+    bool deadlinePassed() const;
+
+    SearchStatus stepAra(std::size_t iterations);
+    void finishAraPass();
+    void rebuildAraOpen();
+
+    SearchStatus stepFocal(std::size_t iterations);
+    void openFocal(std::int32_t idx, std::int32_t g, std::int32_t f);
+    void closeFocal(std::int32_t idx);
+    void refillFocal(bool rebuild);
+    void finishFocalSolution();
+
+    // Relaxes the neighbors of idx; onImproved(nIdx, oldG, oldF) runs after g/parent/f are set.
+    template <typename OnImproved>
+    void relaxNeighbors(std::int32_t idx, OnImproved&& onImproved);
+    void publishPath(double bound);
+
+    AnytimeOptions options_{};
+    AnytimeOptions active_{};
+    double weight_{1.0};
+    int solutions_{0};
+    std::int32_t startIdx_{0};
+    std::int32_t goalIdx_{0};
+    std::chrono::steady_clock::time_point deadlineAt_{};
+
+    // ARA*: closedIn_ holds the pass that closed a cell, queued_ marks OPEN and INCONS members.
+    std::pmr::vector<QueueItem> araOpen_;
+    std::pmr::vector<QueueItem> araNext_; // rebuildAraOpen scratch, kept for its capacity
+    std::pmr::vector<std::uint32_t> closedIn_;
+    std::pmr::vector<std::uint8_t> queued_;
+    std::pmr::vector<std::int32_t> incons_;
+    std::uint32_t pass_{1};
+    // g + h by slot, the ordering key of both variants.
+    std::pmr::vector<std::int32_t> f_;
+
+    // Focal search; the tree nodes come from queryMemory().
+    std::pmr::set<RankedCell> openByF_;
+    std::pmr::set<RankedCell> focal_;
+    double focalLimit_{0.0};
+    std::int32_t incumbent_{SearchSnapshot::kInfScore};
+};
+
+} // namespace pathcore
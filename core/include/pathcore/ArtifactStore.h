@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/MappedFile.h"
+
+namespace pathcore {
+
+struct ArtifactError {
+    std::string message;
+};
+
+// Names one preprocessing result. `kind` is a short file-name-safe tag ("landmarks"),
+// `version` changes with the payload layout and `params` folds in whatever build parameters
+// change the result (move rules, landmark count, ...).
+struct ArtifactKey {
+    std::string kind;
+    std::uint32_t version{1};
+    std::uint64_t params{0};
+};
+
+// A loaded artifact file. The payload starts 8-byte aligned and stays valid while the
+// Artifact lives; structures that read from it in place keep a shared_ptr to it.
+class Artifact {
+public:
+    const std::uint8_t* data() const {
+        return payload_;
+    }
+    std::size_t size() const {
+        return size_;
+    }
+
+private:
+    friend class ArtifactStore;
+
+    MappedFile file_;
+    const std::uint8_t* payload_{nullptr};
+    std::size_t size_{0};
+};
+
+// Versioned binary sidecar files for expensive preprocessing, one per (kind, params, grid
+// content) in a directory next to the map (directoryForMap: "mapa1.pvz" -> "mapa1.pvz.cache/").
+// Files carry Grid::contentHash(), so a stale file is simply never found. Storing a file for
+// the grid last passed to store() or rebuildAsync() removes the other files of the same kind
+// and params; a worker that finishes after the map moved on leaves them alone. Files are
+// written under a temporary name and renamed into place, so readers never see half a file.
+class ArtifactStore {
+public:
+    // Fills `payload`; returning false stores nothing.
+    using Builder = std::function<bool(const Grid& grid, std::vector<std::uint8_t>& payload)>;
+
+    static std::string directoryForMap(const std::string& mapPath);
+
+    explicit ArtifactStore(std::string directory = {});
+    ~ArtifactStore();
+    ArtifactStore(const ArtifactStore&) = delete;
+    ArtifactStore& operator=(const ArtifactStore&) = delete;
+
+    // Builds still running keep writing to the directory they started with.
+    void setDirectory(std::string directory);
+    const std::string& directory() const;
+    bool enabled() const;
+
+    std::string filePath(const Grid& grid, const ArtifactKey& key) const;
+    // Maps the file for `grid` as it is now, or returns null.
+    std::shared_ptr<const Artifact> load(const Grid& grid, const ArtifactKey& key, ArtifactError* err = nullptr) const;
+    bool store(const Grid& grid, const ArtifactKey& key, const std::vector<std::uint8_t>& payload,
+        ArtifactError* err = nullptr) const;
+
+    // Runs `build` on a deep copy of `grid` on a worker thread and stores the result. Returns false
+    // when the store is disabled or the same file is already being built.
+    bool rebuildAsync(const Grid& grid, const ArtifactKey& key, Builder build);
+    std::size_t pendingBuilds() const;
+    void waitForBuilds();
+
+private:
+    static bool storeIn(const std::string& directory, const Grid& grid, const ArtifactKey& key,
+        const std::vector<std::uint8_t>& payload, ArtifactError* err);
+    // Removes the files of `key` other than the one for `contentHash`, if that is still the
+    // current content; called with mutex_ held.
+    void removeOthers(const std::string& directory, const ArtifactKey& key, std::uint64_t contentHash) const;
+    void reapFinished();
+
+    std::string directory_;
+    mutable std::mutex mutex_;
+    // Grid::contentHash() of the grid last passed to store() or rebuildAsync().
+    mutable std::uint64_t currentHash_{0};
+    // Files being built; a worker removes its own entry when done.
+    std::set<std::string> building_;
+    std::vector<std::pair<std::string, std::thread>> workers_;
+};
+
+} // namespace pathcore
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "pathcore/CoroutineSearch.h"
+
+namespace pathcore {
+
+// Dijkstra from both ends, written as a single coroutine: the two frontiers, their open lists
+// (on queryMemory()) and the best meeting cost are locals of run(). Each yield expands one
+// cell of the side with the smaller frontier key; the search ends when the keys add up to the
+// best meeting cost. The snapshot shows both trees, with g and parents of the forward one.
+// Turn penalties depend on the incoming direction, so with them only the forward side runs.
+class BidirectionalDijkstra final : public CoroutineSearch {
+public:
+    BidirectionalDijkstra() = default;
+    explicit BidirectionalDijkstra(std::pmr::memory_resource* upstream)
+        : CoroutineSearch(upstream)
+        , gBack_(upstream)
+        , parentBack_(upstream)
+        , closed_(upstream) {
+    }
+
+protected:
+    SearchTask run() override;
+
+private:
+    SearchTask runForward();
+    // Joins the backward chain from `meet` onto the forward tree and publishes the path.
+    void joinAt(std::int32_t meet);
+
+    std::pmr::vector<std::int32_t> gBack_;
+    std::pmr::vector<std::int32_t> parentBack_;
+    // Bit 0: closed forward, bit 1: closed backward.
+    std::pmr::vector<std::uint8_t> closed_;
+};
+
+} // namespace pathcore
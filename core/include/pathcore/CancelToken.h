@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+
+namespace pathcore {
+
+// Cooperative cancellation shared between a search and other threads. Engines look at it every
+// few expansions (see ISearch::setCancelToken); the token must outlive the searches using it.
+class CancelToken {
+public:
+    CancelToken() = default;
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    void cancel() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+        return cancelled_.load(std::memory_order_relaxed);
+    }
+
+    // Rearms the token for the next search.
+    void reset() {
+        cancelled_.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+} // namespace pathcore
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathcore/ArtifactStore.h"
+#include "pathcore/Grid.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+// Which moves connect two free cells. Eight-neighbor searches without corner cutting only move
+// diagonally when both orthogonal cells are free, so they connect exactly like Four.
+enum class Connectivity : std::uint8_t {
+    Four = 0,
+    Eight
+};
+
+inline Connectivity connectivityFor(const SearchConfig& config) {
+    if (config.neighborMode == NeighborMode::Eight && config.allowCornerCutting) {
+        return Connectivity::Eight;
+    }
+    return Connectivity::Four;
+}
+
+// Connected-component labels of the free cells of a Grid. Cells hold a component id and ids
+// are merged through a small union-find, so opening a cell never relabels cells.
+class ComponentLabels {
+public:
+    static constexpr std::int32_t kBlocked = -1;
+
+    // Labels every cell; large grids are split into row bands labeled on `threads` threads
+    // (0 = hardware concurrency).
+    void build(const Grid& grid, Connectivity connectivity, int threads = 0);
+    void invalidate();
+
+    bool valid() const;
+    // True for the grid version the labels were built for or kept up to date with.
+    bool matches(const Grid& grid, Connectivity connectivity) const;
+    Connectivity connectivity() const;
+    bool needsRebuild() const;
+
+    // Canonical component id of a cell, or kBlocked.
+    std::int32_t label(CellPos p) const;
+    bool isReachable(CellPos a, CellPos b) const;
+    int componentCount() const;
+
+    // The labels as an ArtifactStore payload; loading copies them, since edits patch them.
+    static ArtifactKey artifactKey(Connectivity connectivity);
+    bool writeArtifact(std::vector<std::uint8_t>& payload) const;
+    bool loadArtifact(const Grid& grid, Connectivity connectivity, const Artifact& artifact);
+
+    // Incremental upkeep for single-cell edits already applied to `grid`. Opening a cell unions
+    // it with its neighbors; blocking one floods only the regions it may have cut off.
+    void onCellOpened(const Grid& grid, CellPos p);
+    void onCellBlocked(const Grid& grid, CellPos p);
+    // Cost edits leave connectivity alone; this only carries the labels over to grid.version().
+    void onCostChanged(const Grid& grid);
+
+private:
+    std::int32_t find(std::int32_t id) const;
+    std::int32_t unite(std::int32_t a, std::int32_t b);
+    std::int32_t newComponent();
+    int ringGroups(CellPos p, CellPos* reps) const;
+    bool splitAround(const CellPos* reps, int count);
+
+    int width_{0};
+    int height_{0};
+    // Grid::version the labels describe.
+    std::uint64_t gridVersion_{0};
+    Connectivity connectivity_{Connectivity::Four};
+    bool valid_{false};
+    bool needsRebuild_{false};
+    int componentCount_{0};
+    std::vector<std::int32_t> cellLabel_;
+    mutable std::vector<std::int32_t> parent_;
+    // Scratch marks for splitAround, stamped so they never need clearing.
+    std::vector<std::uint32_t> visitStamp_;
+    std::vector<std::uint8_t> visitOwner_;
+    std::uint32_t stamp_{0};
+};
+
+} // namespace pathcore
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "pathcore/SearchEngine.h"
+#include "pathcore/SearchTask.h"
+
+namespace pathcore {
+
+// ISearch on top of a SearchTask, so step()/stepUntil() callers such as AppState::tick drive
+// coroutine engines unchanged. reset() runs commonReset and then the body of run() up to its
+// first co_yield, where engines do their setup (co_yield 0). The body reports its verdict
+// through status_/path_ before it returns; returning while still Running means NoPath. The
+// frame itself lives in queryMemory() and is destroyed before commonReset, so its locals may
+// allocate from there too.
+class CoroutineSearch : public SearchEngine {
+public:
+    CoroutineSearch() = default;
+    explicit CoroutineSearch(std::pmr::memory_resource* upstream)
+        : SearchEngine(upstream) {
+    }
+
+    bool reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) final;
+    SearchStatus step(std::size_t iterations = 1) final;
+
+protected:
+    virtual SearchTask run() = 0;
+
+private:
+    friend struct SearchTask::promise_type;
+
+    SearchTask task_;
+};
+
+} // namespace pathcore
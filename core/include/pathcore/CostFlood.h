@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/SearchConfig.h"
+
+namespace pathcore {
+
+enum class FloodDirection : std::uint8_t {
+    FromSeeds = 0, // dist[slot] = cheapest cost from the nearest seed to slot
+    ToSeeds        // dist[slot] = cheapest cost from slot to the nearest seed
+};
+
+// Multi-source Dijkstra over the padded slots of `grid` with the engines' move rules (neighbor
+// mode, weights, corner cutting). Turn penalties are ignored, so with them enabled the results
+// are lower bounds. `dist` is resized to grid.paddedStorageSize(); slots no seed connects to
+// hold SearchSnapshot::kInfScore.
+void floodCosts(const Grid& grid,
+    const SearchConfig& config,
+    const std::vector<std::int32_t>& seedSlots,
+    FloodDirection direction,
+    std::vector<std::int32_t>& dist);
+
+} // namespace pathcore
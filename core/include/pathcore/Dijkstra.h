@@ -2,40 +2,35 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <queue>
-#include <vector>
+#include <memory_resource>
 
-#include "pathcore/ISearch.h"
-#include "pathcore/SearchBase.h"
+
+#include "pathcore/SearchEngine.h"
 
 namespace pathcore {
 
-class Dijkstra final : public ISearch, public SearchBase {
+class Dijkstra final : public SearchEngine {
 public:
+    Dijkstra() = default;
+    explicit Dijkstra(std::pmr::memory_resource* upstream)
+        : SearchEngine(upstream) {
+    }
+
     bool reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) override;
     SearchStatus step(std::size_t iterations = 1) override;
-    SearchStatus status() const override {
-        return SearchBase::status();
-    }
-    const SearchSnapshot& snapshot() const override {
-        return SearchBase::snapshot();
-    }
+    // The tree grown from the start is valid for any goal: a settled goal is answered at once,
+    // otherwise expansion resumes from the saved open list.
+    bool retarget(CellPos goal) override;
 
 private:
-    struct QueueItem {
-        std::int32_t dist;
-        std::int32_t idx;
-    };
-
+    // Open entries are keyed by distance.
     struct QueueItemCompare {
-        bool operator()(const QueueItem& a, const QueueItem& b) const {
-            return a.dist > b.dist;
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const {
+            return a.key > b.key;
         }
     };
 
-    void rebuildPath(std::int32_t startIdx, std::int32_t goalIdx);
-
-    std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemCompare> open_;
+    bool goalUnexpanded_{false};
 };
 
 } // namespace pathcore
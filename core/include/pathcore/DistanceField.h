@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/IndexMap.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+// Cost from every cell to the nearest of a set of goals, plus a flow field giving the first move
+// of a cheapest path, so any number of agents can walk to the goals with O(1) lookups per step.
+// Costs follow the engines' move rules without turn penalties.
+class DistanceField {
+public:
+    bool build(const Grid& grid, const SearchConfig& config, const std::vector<CellPos>& goals);
+    // Repairs the field after the cells in `changed` were edited on `grid` (walls or costs).
+    // Only cells whose cheapest path ran through an edited cell, plus whatever the edit made
+    // cheaper, are recomputed.
+    bool update(const Grid& grid, const std::vector<CellPos>& changed);
+    void clear();
+
+    bool valid() const;
+    // Also false once `grid` was edited without a matching update().
+    bool matches(const Grid& grid, const SearchConfig& config) const;
+    const std::vector<CellPos>& goals() const;
+
+    // SearchSnapshot::kInfScore when no goal can be reached.
+    std::int32_t distance(CellPos p) const;
+    // Direction code of the next move towards the nearest goal, or -1 (goal or unreachable).
+    int direction(CellPos p) const;
+    // Largest finite distance, for normalizing heatmaps.
+    std::int32_t maxDistance() const;
+    // Cells from `p` to the goal following the flow field (empty when unreachable).
+    std::vector<CellPos> pathFrom(CellPos p) const;
+
+private:
+    static constexpr std::uint8_t kNoDir = 0xFF;
+
+    bool legalMove(const Grid& grid, std::int32_t slot, int dir) const;
+    std::int32_t stepCost(const Grid& grid, std::int32_t slot) const;
+    // Cheapest legal move out of `slot` given the neighbors' current distances.
+    void settleFromNeighbors(const Grid& grid, std::int32_t slot);
+    std::int32_t slotOf(CellPos p) const;
+
+    bool valid_{false};
+    int width_{0};
+    int height_{0};
+    IndexLayout layout_{IndexLayout::RowMajor};
+    std::uint64_t gridVersion_{0};
+    IndexMap paddedIndex_{};
+    int pad_{0};
+    SearchConfig config_{};
+    std::vector<CellPos> goals_;
+    // Indexed by padded slot, like the engines.
+    std::vector<std::int32_t> dist_;
+    std::vector<std::uint8_t> flow_;
+    std::vector<std::uint32_t> mark_;
+    std::uint32_t stamp_{0};
+};
+
+} // namespace pathcore
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "pathcore/IndexMap.h"
 #include "pathcore/Types.h"
 
 namespace pathcore {
@@ -11,18 +15,40 @@ struct Cell {
     int cost{1};
 };
 
+// Copies share storage and copy on write: cells live in chunks of kChunkSlots consecutive
+// storage slots (16 tiles for Tiled; for RowMajor 1024 cells in row order, which only line up
+// with rows when the width divides 1024) and an edit clones only the chunk it lands in. The
+// padded cost array the engines read is each Grid's own: an edit writes its slot, and assigning
+// a grid of the same shape rewrites only the slots of the chunks the two do not share. Like a
+// std::vector, a Grid must not be copied while another thread edits it. Whether a chunk may be
+// written in place is read from plain reference counts, so a grid handed to another thread
+// should be a deepCopy().
 class Grid {
 public:
-    Grid(int width, int height, int defaultCost = 1);
+    static constexpr int kChunkShift = 10;
+    static constexpr int kChunkSlots = 1 << kChunkShift;
+    static constexpr int kChunkMask = kChunkSlots - 1;
+
+    Grid(int width, int height, int defaultCost = 1, IndexLayout layout = IndexLayout::RowMajor);
+    Grid(const Grid&) = default;
+    Grid(Grid&&) = default;
+    Grid& operator=(const Grid& other);
+    Grid& operator=(Grid&&) = default;
 
     int width() const;
     int height() const;
     int size() const;
 
+    // Cell index order shared by the grid storage, the engines and SearchSnapshot.
+    const IndexMap& indexMap() const;
+    IndexLayout layout() const;
+    int storageSize() const;
+    int toIndex(CellPos p) const;
+    CellPos fromIndex(int idx) const;
+
     bool inBounds(CellPos p) const;
 
     const Cell& cell(CellPos p) const;
-    Cell& cell(CellPos p);
 
     bool setBlocked(CellPos p, bool blocked);
     bool isBlocked(CellPos p) const;
@@ -32,13 +58,79 @@ public:
     void clearBlocked();
     void fillCost(int cost);
 
+    // Region edits, clipped to the grid and written one contiguous run of cells at a time.
+    // False when `value` (or a pattern cell) has a cost below 1 or nothing lands on the grid.
+    bool fillRect(CellPos origin, int width, int height, const Cell& value);
+    // Copies a row-major pattern `patternWidth` cells wide with its top-left cell at `origin`.
+    bool stamp(CellPos origin, int patternWidth, const std::vector<Cell>& pattern);
+
     std::vector<CellPos> neighbors4(CellPos p) const;
     std::vector<CellPos> neighbors8(CellPos p) const;
 
+    // Engine-facing copy of the costs in storage order with a blocked border (one cell for
+    // RowMajor, one tile for Tiled). 0 marks walls, the border and padding slots, so the
+    // neighbor of `slot` in direction d is simply slot + neighborDeltas(slot)[d] and the
+    // search loop needs no bounds checks. Assigning another grid may move the array, so re-read
+    // it after one.
+    const std::int32_t* paddedCosts() const;
+    int paddedStorageSize() const;
+    int paddedIndex(CellPos p) const;
+    CellPos fromPaddedIndex(int slot) const;
+    // paddedIndex(p) == paddedIndexMap().toIndex({p.x + padding(), p.y + padding()}), for
+    // structures that keep slot-indexed data after the grid is gone.
+    const IndexMap& paddedIndexMap() const;
+    int padding() const;
+    const int* neighborDeltas(int slot) const;
+
+    // Number of cell chunks shared with another Grid.
+    int sharedChunks() const;
+    // A copy that shares no writable storage with this grid.
+    Grid deepCopy() const;
+
+    // Changes with every edit. Versions come from one process-wide counter and travel with
+    // copies, so two grids with the same version hold the same cells.
+    std::uint64_t version() const;
+    // Hash of the size and the cell values (walls as 0, whatever cost lies under them). It does
+    // not depend on the layout, so a map keeps it through MapIO save/load. Hashes of 8x8 tiles
+    // are combined in a binary tree and only the tiles edited since the last call are rehashed;
+    // like SearchBase::snapshot() it updates a cache, so one thread at a time per Grid.
+    std::uint64_t contentHash() const;
+
 private:
+    using CellChunk = std::array<Cell, kChunkSlots>;
+
+    const Cell& cellAt(int idx) const {
+        return (*chunks_[static_cast<std::size_t>(idx >> kChunkShift)])[static_cast<std::size_t>(idx & kChunkMask)];
+    }
+    // Clones the chunk first when another Grid shares it.
+    Cell& mutableCellAt(int idx);
+    void updatePadded(CellPos p);
+    // Copies the padded slots of the cells in chunk `chunk` from `other`, a grid of our shape.
+    void copyPaddedChunk(const Grid& other, std::size_t chunk);
+    // Bumps the version and queues the hash tiles covering [x0, x1) x [y0, y1).
+    void markEdited(int x0, int y0, int x1, int y1);
+    std::uint64_t hashTile(int tile) const;
+    // Cells (x, y) .. (x + count - 1, y), all in bounds, from `values` (`step` 0 repeats one).
+    void writeRow(int x, int y, int count, const Cell* values, int step);
+
     int width_ = 0;
     int height_ = 0;
-    std::vector<Cell> cells_;
+    IndexMap index_;
+    std::vector<std::shared_ptr<CellChunk>> chunks_;
+    int pad_ = 1;
+    IndexMap paddedIndex_;
+    std::vector<std::int32_t> padded_;
+    // Only depends on the layout and the size; never written after construction.
+    std::shared_ptr<const std::vector<int>> deltas_;
+
+    std::uint64_t version_{0};
+    int hashTilesX_{0};
+    int hashTileCount_{0};
+    // Heap-ordered tree: node i has children 2i and 2i + 1, tile t is leaf hashLeaves_ + t.
+    int hashLeaves_{1};
+    mutable std::shared_ptr<std::vector<std::uint64_t>> hashTree_;
+    mutable std::vector<std::int32_t> dirtyTiles_;
+    mutable bool hashStale_{true};
 };
 
 } // namespace pathcore
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+// Extra goal-distance estimate for AStar, combined with its built-in heuristic by max(), so a
+// provider only has to be admissible and consistent, not better everywhere.
+class HeuristicProvider {
+public:
+    virtual ~HeuristicProvider() = default;
+
+    // Called from AStar::reset; returning false makes that search use the built-in heuristic.
+    virtual bool prepare(const Grid& grid, CellPos goal, const SearchConfig& config) = 0;
+    // Lower bound on the cost from `p` to the prepared goal. `slot` is grid.paddedIndex(p).
+    virtual std::int32_t estimate(CellPos p, std::int32_t slot) const = 0;
+
+    struct SettledCell {
+        std::int32_t slot;
+        std::int32_t g;
+    };
+    // Providers that learn from finished searches override this to return true, and learn().
+    // AStar only collects the settled cells, a scan of the whole grid, when it is true.
+    virtual bool wantsLearning() const {
+        return false;
+    }
+    // Called by AStar after it found `goal` at `goalCost`, with every expanded cell and its final
+    // g.
+    virtual void learn(const Grid& grid, CellPos goal, std::int32_t goalCost,
+        const std::vector<SettledCell>& settled) {
+        (void)grid;
+        (void)goal;
+        (void)goalCost;
+        (void)settled;
+    }
+};
+
+} // namespace pathcore
@@ -1,22 +1,54 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 
+#include "pathcore/CancelToken.h"
+
+#include "pathcore/Components.h"
 #include "pathcore/Grid.h"
 #include "pathcore/SearchConfig.h"
+#include "pathcore/SearchPath.h"
 #include "pathcore/SearchSnapshot.h"
 #include "pathcore/SearchStatus.h"
 
 namespace pathcore {
 
+class SearchProfile;
+class SearchRecorder;
+class SearchWorkspace;
+
 class ISearch {
 public:
     virtual ~ISearch() = default;
 
     virtual bool reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) = 0;
     virtual SearchStatus step(std::size_t iterations = 1) = 0;
+    // Expands until the search ends or `deadline` passes; the clock is read every
+    // SearchBase::kCheckStride expansions, so it may overrun by that much work.
+    virtual SearchStatus stepUntil(std::chrono::steady_clock::time_point deadline) = 0;
     virtual SearchStatus status() const = 0;
     virtual const SearchSnapshot& snapshot() const = 0;
+    virtual const SearchPath& path() const = 0;
+    // Cells expanded since the last reset().
+    virtual std::uint64_t expansions() const = 0;
+    // Lets reset() answer NoPath up front when start and goal lie in different components.
+    virtual void setComponentLabels(const ComponentLabels* labels) = 0;
+    // Moves the goal of the current search, keeping its work, on the grid and config it was
+    // reset with. Returns false when the engine cannot, or when the grid was edited since
+    // (Grid::version); the caller should reset() instead.
+    virtual bool retarget(CellPos goal) = 0;
+    // Once `token` is cancelled a running search stops within kCheckStride expansions with
+    // SearchStatus::Cancelled (nullptr disables it). Safe to cancel from another thread.
+    virtual void setCancelToken(const CancelToken* token) = 0;
+    // Lends the engine a SearchWorkspace's buffers (see SearchBase::setWorkspace).
+    virtual void setWorkspace(SearchWorkspace* workspace) = 0;
+    // Records the search for replay from the next reset() on (see SearchRecorder).
+    virtual void setRecorder(SearchRecorder* recorder) = 0;
+    // Counts per-cell expansions, pushes, stale pops and reopens from the next reset() on
+    // (see SearchProfile).
+    virtual void setProfile(SearchProfile* profile) = 0;
 };
 
 } // namespace pathcore
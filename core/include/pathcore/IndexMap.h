@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+// RowMajor is the classic y * width + x order. Tiled stores 8x8 blocks contiguously so
+// vertical neighbors usually share a cache line (partial edge tiles are padded).
+enum class IndexLayout : std::uint8_t {
+    RowMajor = 0,
+    Tiled
+};
+
+class IndexMap {
+public:
+    static constexpr int kTileShift = 3;
+    static constexpr int kTileSize = 1 << kTileShift;
+    static constexpr int kTileMask = kTileSize - 1;
+
+    IndexMap() = default;
+
+    IndexMap(int width, int height, IndexLayout layout)
+        : width_(width), height_(height), layout_(layout) {
+        if (width_ <= 0 || height_ <= 0) {
+            width_ = 0;
+            height_ = 0;
+        }
+        tilesX_ = (width_ + kTileMask) >> kTileShift;
+        tilesY_ = (height_ + kTileMask) >> kTileShift;
+    }
+
+    int width() const {
+        return width_;
+    }
+
+    int height() const {
+        return height_;
+    }
+
+    IndexLayout layout() const {
+        return layout_;
+    }
+
+    // Number of slots backing arrays need; only differs from width * height for Tiled.
+    int storageSize() const {
+        if (layout_ == IndexLayout::Tiled) {
+            return (tilesX_ * tilesY_) << (2 * kTileShift);
+        }
+        return width_ * height_;
+    }
+
+    int toIndex(CellPos p) const {
+        if (layout_ == IndexLayout::Tiled) {
+            const int tile = (p.y >> kTileShift) * tilesX_ + (p.x >> kTileShift);
+            return (tile << (2 * kTileShift)) | ((p.y & kTileMask) << kTileShift) | (p.x & kTileMask);
+        }
+        return p.y * width_ + p.x;
+    }
+
+    CellPos fromIndex(int idx) const {
+        if (width_ <= 0) {
+            return CellPos{0, 0};
+        }
+        if (layout_ == IndexLayout::Tiled) {
+            const int tile = idx >> (2 * kTileShift);
+            const int local = idx & ((1 << (2 * kTileShift)) - 1);
+            const int tx = tile % tilesX_;
+            const int ty = tile / tilesX_;
+            return CellPos{(tx << kTileShift) | (local & kTileMask), (ty << kTileShift) | (local >> kTileShift)};
+        }
+        return CellPos{idx % width_, idx / width_};
+    }
+
+private:
+    int width_{0};
+    int height_{0};
+    IndexLayout layout_{IndexLayout::RowMajor};
+    int tilesX_{0};
+    int tilesY_{0};
+};
+
+} // namespace pathcore
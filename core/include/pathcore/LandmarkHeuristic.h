@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "pathcore/ArtifactStore.h"
+#include "pathcore/Grid.h"
+#include "pathcore/HeuristicProvider.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+// ALT heuristic: exact costs from and to a few landmarks bound the cost between any two cells
+// through the triangle inequality. Tables hold one uint16 per landmark, direction and padded
+// slot; costs that do not fit are stored as kUnknown and simply give no bound.
+//
+// The tables describe the grid they were built from. Opening cells or lowering costs makes them
+// inadmissible, so prepare() refuses once the grid was edited since build (current()) and A*
+// falls back to its built-in heuristic until the tables are rebuilt.
+class LandmarkHeuristic final : public HeuristicProvider {
+public:
+    static constexpr std::uint16_t kUnknown = 0xFFFF;
+
+    // Picks `landmarkCount` landmarks by farthest-point selection and floods from and to each
+    // of them on `threads` threads (0 = hardware concurrency).
+    bool build(const Grid& grid, const SearchConfig& config, int landmarkCount = 8, int threads = 0);
+    void clear();
+
+    bool valid() const;
+    bool matches(const Grid& grid, const SearchConfig& config) const;
+    // matches() and `grid` has not been edited since build (Grid::version).
+    bool current(const Grid& grid, const SearchConfig& config) const;
+    const std::vector<CellPos>& landmarks() const;
+
+    // The tables as an ArtifactStore payload. loadArtifact() reads them in place from the
+    // mapped file; loadFrom() does that or, when the store has no file for this grid yet,
+    // queues a build there and returns false so the caller can fall back until a later call.
+    static ArtifactKey artifactKey(const Grid& grid, const SearchConfig& config, int landmarkCount = 8);
+    bool writeArtifact(std::vector<std::uint8_t>& payload) const;
+    bool loadArtifact(const Grid& grid, const SearchConfig& config, std::shared_ptr<const Artifact> artifact);
+    bool loadFrom(ArtifactStore& store, const Grid& grid, const SearchConfig& config, int landmarkCount = 8);
+
+    bool prepare(const Grid& grid, CellPos goal, const SearchConfig& config) override;
+    std::int32_t estimate(CellPos p, std::int32_t slot) const override;
+
+private:
+    void selectLandmarks(const Grid& grid, int count);
+
+    bool valid_{false};
+    int width_{0};
+    int height_{0};
+    IndexLayout layout_{IndexLayout::RowMajor};
+    std::uint64_t gridVersion_{0};
+    NeighborMode neighborMode_{NeighborMode::Four};
+    bool useWeights_{false};
+    bool allowCornerCutting_{false};
+    std::size_t slots_{0};
+    std::vector<CellPos> landmarks_;
+    std::vector<std::int32_t> landmarkSlots_;
+    // Landmark-major: [k * slots_ + slot]. The tables point into the vectors after build()
+    // and into artifact_ after loadArtifact().
+    const std::uint16_t* fromTable_{nullptr};
+    const std::uint16_t* toTable_{nullptr};
+    std::vector<std::uint16_t> fromLandmark_;
+    std::vector<std::uint16_t> toLandmark_;
+    std::shared_ptr<const Artifact> artifact_;
+    // Costs landmark -> goal and goal -> landmark for the prepared goal, -1 when unknown.
+    std::vector<std::int32_t> goalFrom_;
+    std::vector<std::int32_t> goalTo_;
+};
+
+} // namespace pathcore
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "pathcore/Grid.h"
+#include "pathcore/IndexMap.h"
 #include "pathcore/Types.h"
 
 namespace pathcore {
@@ -21,6 +22,7 @@ struct MapIoError {
 bool saveMapToFile(const Grid& grid, CellPos start, CellPos goal, const std::string& filePath,
                    MapIoError* err = nullptr);
 
-std::optional<LoadedMap> loadMapFromFile(const std::string& filePath, MapIoError* err = nullptr);
+std::optional<LoadedMap> loadMapFromFile(const std::string& filePath, MapIoError* err = nullptr,
+                                         IndexLayout layout = IndexLayout::RowMajor);
 
 } // namespace pathcore
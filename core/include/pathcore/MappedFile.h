@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pathcore {
+
+// Read-only view of a whole file: mmap on POSIX, a plain read into memory elsewhere.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filePath, std::string* err = nullptr);
+    void close();
+
+    bool isOpen() const;
+    const std::uint8_t* data() const;
+    std::size_t size() const;
+
+private:
+    const std::uint8_t* data_{nullptr};
+    std::size_t size_{0};
+    bool mapped_{false};
+    std::vector<std::uint8_t> buffer_;
+};
+
+} // namespace pathcore
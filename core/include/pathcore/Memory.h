@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace pathcore {
+
+// Forwards to `upstream` and counts what passes through. Install it as the default resource
+// (std::pmr::set_default_resource) before building engines and workspaces, or hand it to an
+// engine as its upstream, to check that warm queries allocate nothing.
+class CountingResource final : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    std::uint64_t allocations() const {
+        return allocations_;
+    }
+    std::uint64_t deallocations() const {
+        return deallocations_;
+    }
+    std::uint64_t bytesAllocated() const {
+        return bytesAllocated_;
+    }
+    // Bytes allocated and not yet returned.
+    std::uint64_t bytesInUse() const {
+        return bytesInUse_;
+    }
+    void resetCounters();
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* upstream_;
+    std::uint64_t allocations_{0};
+    std::uint64_t deallocations_{0};
+    std::uint64_t bytesAllocated_{0};
+    std::uint64_t bytesInUse_{0};
+};
+
+// Memory for one query's temporaries (node sets, side open lists, scratch maps): a pool over a
+// monotonic buffer, all dropped at once by release(). The buffer grows to the largest query
+// seen, so once warm a query never reaches `upstream`. Containers using resource() must be
+// destroyed or emptied with their storage before release().
+class QueryArena {
+public:
+    explicit QueryArena(std::size_t initialBytes = 0,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    std::pmr::memory_resource* resource();
+    void release();
+    std::size_t capacity() const;
+
+private:
+    void rebuild();
+
+    CountingResource overflow_;
+    std::pmr::vector<std::byte> buffer_;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool_;
+};
+
+} // namespace pathcore
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/SearchPath.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+struct PathCacheOptions {
+    // Approximate cap on entries plus their index; the least recently used go first.
+    std::size_t maxBytes{8u << 20};
+    // Answer from a slice of a cached path that runs through both cells (in either direction).
+    // Never used with turn penalties, where a slice can miss a cheaper first turn.
+    bool subPaths{true};
+};
+
+struct PathCacheStats {
+    std::uint64_t lookups{0};
+    std::uint64_t hits{0};        // same query
+    std::uint64_t subPathHits{0}; // answered from a slice
+    std::uint64_t inserts{0};
+    std::uint64_t evictions{0};
+    std::size_t entries{0};
+    std::size_t bytes{0};
+
+    double hitRate() const {
+        return lookups == 0 ? 0.0 : static_cast<double>(hits + subPathHits) / static_cast<double>(lookups);
+    }
+};
+
+// Thread-safe LRU cache of optimal paths. Entries are keyed on start, goal, the SearchConfig
+// fields that change results and Grid::version(), so after an edit older entries are never
+// returned; they age out, or dropOtherVersions() frees them at once. Paths are kept as their
+// first cell plus one 4-bit move per step.
+class PathCache {
+public:
+    explicit PathCache(const PathCacheOptions& options = {});
+    PathCache(const PathCache&) = delete;
+    PathCache& operator=(const PathCache&) = delete;
+
+    // Fills `out` on a hit. `grid` must not be edited during the call.
+    bool lookup(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config, SearchPath* out);
+    // Stores a path found on `grid`; paths with SearchPath::bound above 1 are ignored.
+    void insert(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config, const SearchPath& path);
+    // Frees every entry not built on `grid` as it is now.
+    void dropOtherVersions(const Grid& grid);
+    void clear();
+
+    void setMaxBytes(std::size_t bytes);
+    PathCacheStats stats() const;
+
+private:
+    struct QueryKey {
+        std::uint64_t gridVersion{0};
+        std::uint64_t config{0};
+        CellPos start{};
+        CellPos goal{};
+        bool operator==(const QueryKey& other) const;
+    };
+    struct QueryKeyHash {
+        std::size_t operator()(const QueryKey& key) const;
+    };
+    struct CellKey {
+        std::uint64_t gridVersion{0};
+        std::uint64_t config{0};
+        CellPos cell{};
+        bool operator==(const CellKey& other) const;
+    };
+    struct CellKeyHash {
+        std::size_t operator()(const CellKey& key) const;
+    };
+    struct Entry {
+        QueryKey key{};
+        std::vector<std::uint8_t> moves; // two per byte, low nibble first
+        std::uint32_t length{0};         // cells, start and goal included
+        std::int32_t cost{0};
+        std::size_t bytes{0};
+        bool indexed{false};
+    };
+    using EntryList = std::list<Entry>;
+    struct Occurrence {
+        EntryList::iterator entry;
+        std::uint32_t pos{0};
+    };
+
+    static std::uint64_t configKey(const SearchConfig& config);
+    bool sliceLookup(const Grid& grid, const QueryKey& key, const SearchConfig& config, SearchPath* out);
+    void erase(EntryList::iterator it);
+    void evictToFit();
+
+    mutable std::mutex mutex_;
+    PathCacheOptions options_;
+    // Most recently used first.
+    EntryList lru_;
+    std::unordered_map<QueryKey, EntryList::iterator, QueryKeyHash> byQuery_;
+    std::unordered_map<CellKey, std::vector<Occurrence>, CellKeyHash> byCell_;
+    PathCacheStats stats_{};
+};
+
+} // namespace pathcore
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "pathcore/Grid.h"
+#include "pathcore/IndexMap.h"
+#include "pathcore/MappedFile.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/SearchEngine.h"
+
+namespace pathcore {
+
+struct PathDatabaseError {
+    std::string message;
+};
+
+struct PathDatabaseHeader;
+
+// Compressed path database: for every source cell, the optimal first move towards every target,
+// run-length encoded over the targets in 8x8 tiled order (walls and the source itself are
+// "don't care" and extend the current run). Built offline with one Dijkstra per source.
+// Turn penalties are not supported, since first moves would then depend on the heading.
+bool buildPathDatabase(const Grid& grid,
+    const SearchConfig& config,
+    const std::string& filePath,
+    int threads = 0,
+    PathDatabaseError* err = nullptr);
+
+// Answers queries from a memory-mapped database file. reset() follows first moves from start
+// to goal, so a query costs one binary search per path cell and step() has nothing left to do.
+class PathDatabase final : public SearchEngine {
+public:
+    bool open(const std::string& filePath, PathDatabaseError* err = nullptr);
+    void close();
+    bool isOpen() const;
+    // True when the file was built for exactly this grid content and move rules.
+    bool matches(const Grid& grid, const SearchConfig& config) const;
+    // Direction code of the first optimal move from `from` towards `to`, or -1.
+    int firstMove(CellPos from, CellPos to) const;
+
+    bool reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) override;
+    SearchStatus step(std::size_t iterations = 1) override;
+
+private:
+    MappedFile file_;
+    const PathDatabaseHeader* header_{nullptr};
+    const std::uint64_t* rowStart_{nullptr};
+    const std::uint32_t* runs_{nullptr};
+    IndexMap targetOrder_;
+};
+
+} // namespace pathcore
@@ -1,22 +1,56 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
 
+#include "pathcore/CancelToken.h"
+#include "pathcore/Components.h"
 #include "pathcore/Grid.h"
+#include "pathcore/Memory.h"
+#include "pathcore/NodeState.h"
 #include "pathcore/SearchConfig.h"
+#include "pathcore/SearchPath.h"
+#include "pathcore/SearchProfile.h"
+#include "pathcore/SearchRecorder.h"
 #include "pathcore/SearchSnapshot.h"
 #include "pathcore/SearchStatus.h"
 #include "pathcore/Types.h"
 
 namespace pathcore {
 
+class SearchWorkspace;
+
 class SearchBase {
 public:
+    SearchBase() = default;
+    // `upstream` backs the per-cell arrays, the open list, the path and the query arena.
+    explicit SearchBase(std::pmr::memory_resource* upstream);
+    SearchBase(const SearchBase&) = delete;
+    SearchBase& operator=(const SearchBase&) = delete;
+    ~SearchBase();
+
     bool commonReset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) {
+        // Engines empty their containers on queryMemory() before calling this.
+        queryArena_.release();
+        if (recorder_ != nullptr) {
+            recorder_->clear();
+        }
+        if (profile_ != nullptr) {
+            profile_->clear();
+        }
         grid_ = nullptr;
         start_ = {};
         goal_ = {};
         status_ = SearchStatus::NotStarted;
+        expansions_ = 0;
+        path_.clear();
+        dirty_.clear();
+        snapshotStale_ = false;
 
         if (grid.width() <= 0 || grid.height() <= 0) {
             snapshot_.resize(0, 0);
@@ -32,23 +66,72 @@ public:
         }
 
         grid_ = &grid;
+        gridVersion_ = grid.version();
         start_ = start;
         goal_ = goal;
         config_ = config;
-        snapshot_.resize(grid.width(), grid.height());
-        snapshot_.clear();
+        // Engines index their arrays by the grid's padded slots (see Grid::paddedCosts).
+        const std::size_t total = static_cast<std::size_t>(grid.paddedStorageSize());
+        hot_.assign(total, HotNode{});
+        // The public snapshot is only built when somebody asks for it (see syncSnapshot).
+        snapshotStale_ = true;
+        if (recorder_ != nullptr) {
+            recorder_->begin(grid, config);
+        }
+        if (profile_ != nullptr) {
+            profile_->begin(grid);
+        }
         status_ = SearchStatus::Running;
+        if (components_ != nullptr && components_->matches(grid, connectivityFor(config))
+            && !components_->isReachable(start, goal)) {
+            // Different components: report NoPath without expanding anything.
+            status_ = SearchStatus::NoPath;
+        }
         return true;
     }
 
+    // Optional labels consulted by commonReset; they must describe the grid passed to reset
+    // (nullptr disables the check).
+    void setComponentLabels(const ComponentLabels* labels) {
+        components_ = labels;
+    }
+
+    void setCancelToken(const CancelToken* token) {
+        cancel_ = token;
+    }
+
+    // Logs every cell state change into `recorder` from the next reset() on (nullptr stops).
+    void setRecorder(SearchRecorder* recorder) {
+        recorder_ = recorder;
+    }
+
+    // Counts per-cell work into `profile` from the next reset() on (nullptr stops).
+    void setProfile(SearchProfile* profile) {
+        profile_ = profile;
+    }
+
+    // Borrows the per-cell arrays, open list, snapshot and path of `workspace` (nullptr: the
+    // engine's own) until another one is set or the engine is destroyed, when they go back with
+    // their capacity. Drops the current search; one engine per workspace at a time.
+    void setWorkspace(SearchWorkspace* workspace);
+
     SearchStatus status() const {
         return status_;
     }
 
     const SearchSnapshot& snapshot() const {
+        syncSnapshot();
         return snapshot_;
     }
 
+    const SearchPath& path() const {
+        return path_;
+    }
+
+    std::uint64_t expansions() const {
+        return expansions_;
+    }
+
     const Grid& grid() const {
         assert(grid_ != nullptr);
         return *grid_;
@@ -62,13 +145,185 @@ public:
         return goal_;
     }
 
+    // Expansions between two looks at the clock or the cancel token.
+    static constexpr std::size_t kCheckStride = 64;
+
 protected:
+    static constexpr std::uint8_t kNoDir = 0xFF;
+    // Neighbor visiting order (direction codes from Types.h), matching Grid::neighbors4/8.
+    static constexpr int kFourDirs[4] = {0, 4, 2, 6};
+    static constexpr int kEightDirs[8] = {5, 6, 7, 4, 0, 3, 2, 1};
+    // Orthogonal directions a diagonal move squeezes between (only odd codes are diagonal).
+    static constexpr int kDiagAdjX[8] = {0, 0, 0, 4, 0, 4, 0, 0};
+    static constexpr int kDiagAdjY[8] = {0, 2, 0, 2, 0, 6, 0, 6};
+
+    // The whole per-cell state of a search, 8 bytes per padded slot. `dir` is the direction the
+    // cell was reached by: it gives turn penalties and the parent (see parentOf), so engines set
+    // it together with g whenever a neighbor improves. Engines that need f keep it themselves.
+    struct HotNode {
+        std::int32_t g{SearchSnapshot::kInfScore};
+        NodeState state{NodeState::Unseen};
+        std::uint8_t dir{kNoDir};
+    };
+
+    // Open-list entry; engines keep open_ as a binary heap ordered by their own comparator, so
+    // its capacity survives resets.
+    struct OpenEntry {
+        std::int32_t key;
+        std::int32_t g;
+        std::int32_t idx;
+    };
+
+    template <typename Compare>
+    void pushOpen(const OpenEntry& entry, Compare compare) {
+        open_.push_back(entry);
+        std::push_heap(open_.begin(), open_.end(), compare);
+        profilePush(entry.idx);
+    }
+
+    template <typename Compare>
+    OpenEntry popOpen(Compare compare) {
+        std::pop_heap(open_.begin(), open_.end(), compare);
+        const OpenEntry entry = open_.back();
+        open_.pop_back();
+        return entry;
+    }
+
+    void setState(std::int32_t idx, NodeState s) {
+        HotNode& hot = hot_[static_cast<std::size_t>(idx)];
+        if (recorder_ != nullptr) {
+            recordState(idx, s);
+        }
+        if (profile_ != nullptr && s == NodeState::Open && hot.state == NodeState::Closed) {
+            profile_->countReopen(idx);
+        }
+        hot.state = s;
+        if (snapshotStale_) {
+            return;
+        }
+        if (dirty_.size() >= hot_.size()) {
+            // Cheaper to copy everything on the next sync than to keep logging.
+            dirty_.clear();
+            snapshotStale_ = true;
+            return;
+        }
+        dirty_.push_back(idx);
+    }
+
+    // setState for an engine undoing its own bookkeeping, as Dijkstra::retarget reopening the
+    // goal it closed early: recorded, but not counted by the profile as a reopen.
+    void restoreState(std::int32_t idx, NodeState s) {
+        SearchProfile* profile = profile_;
+        profile_ = nullptr;
+        setState(idx, s);
+        profile_ = profile;
+    }
+
+    // For g or parent changes that keep the state, so snapshots and recordings still see them.
+    void touchCell(std::int32_t idx) {
+        setState(idx, hot_[static_cast<std::size_t>(idx)].state);
+    }
+
+    // SearchProfile hooks for engines; no-ops without a profile.
+    void profilePush(std::int32_t idx) {
+        if (profile_ != nullptr) {
+            profile_->countPush(idx);
+        }
+    }
+    void profileStalePop(std::int32_t idx) {
+        if (profile_ != nullptr) {
+            profile_->countStalePop(idx);
+        }
+    }
+    // Also counts the expansion for expansions(), so engines call it for every one.
+    void profileExpansion(std::int32_t idx) {
+        ++expansions_;
+        if (profile_ != nullptr) {
+            profile_->countExpansion(idx);
+        }
+    }
+
+    // True (and status_ set to Cancelled) when the token fired while the search was running.
+    bool cancelRequested() {
+        if (cancel_ == nullptr || status_ != SearchStatus::Running || !cancel_->cancelled()) {
+            return false;
+        }
+        status_ = SearchStatus::Cancelled;
+        return true;
+    }
+
+    // ISearch::stepUntil on top of an engine's step(): runs kCheckStride expansions at a time.
+    template <typename StepFn>
+    SearchStatus stepUntilWith(std::chrono::steady_clock::time_point deadline, StepFn&& stepFn) {
+        while (status_ == SearchStatus::Running) {
+            stepFn(kCheckStride);
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+        return status_;
+    }
+
+    // Per-query memory for engine-side containers, dropped in one go by commonReset.
+    std::pmr::memory_resource* queryMemory() {
+        return queryArena_.resource();
+    }
+
+    int cellCount() const {
+        return static_cast<int>(hot_.size());
+    }
+
+    // Slot the cell was reached from, SearchSnapshot::kNoParent for the start and unreached cells.
+    std::int32_t parentOf(std::int32_t slot) const {
+        const std::uint8_t dir = hot_[static_cast<std::size_t>(slot)].dir;
+        if (dir == kNoDir) {
+            return SearchSnapshot::kNoParent;
+        }
+        return slot + grid_->neighborDeltas(slot)[(dir + 4) & 7];
+    }
+
+    // Walks parents from the goal back to the start (O(path length)), fills path_ and, unless
+    // config_.markPath is off, marks the cells as NodeState::Path.
+    void rebuildPath(std::int32_t startIdx, std::int32_t goalIdx);
+    // Undoes rebuildPath: path cells go back to Closed and path_ is emptied.
+    void clearPathMarks();
+
     const Grid* grid_{nullptr};
+    // Grid::version() at reset; retarget() refuses once the grid moved past it.
+    std::uint64_t gridVersion_{0};
     CellPos start_{};
     CellPos goal_{};
     SearchConfig config_{};
     SearchStatus status_{SearchStatus::NotStarted};
-    SearchSnapshot snapshot_{};
+    std::uint64_t expansions_{0};
+    SearchPath path_{};
+    const ComponentLabels* components_{nullptr};
+    const CancelToken* cancel_{nullptr};
+    std::pmr::vector<HotNode> hot_;
+    // Per-slot f of engines that keep one (AnytimeAStar), copied into snapshots; others leave it
+    // null and their snapshots report kInfScore.
+    const std::pmr::vector<std::int32_t>* fScores_{nullptr};
+    std::pmr::vector<OpenEntry> open_;
+
+private:
+    friend class SearchWorkspace;
+
+    void swapBuffers(SearchWorkspace& workspace);
+
+    // Copies the cells changed since the last call from hot_ into snapshot_, or every
+    // cell when snapshotStale_ is set. Until the first call nothing is logged, so headless
+    // searches never pay for the snapshot.
+    void syncSnapshot() const;
+    void copyCell(std::int32_t slot) const;
+    void recordState(std::int32_t slot, NodeState to);
+
+    mutable SearchSnapshot snapshot_{};
+    mutable std::pmr::vector<std::int32_t> dirty_;
+    mutable bool snapshotStale_{false};
+    SearchWorkspace* workspace_{nullptr};
+    SearchRecorder* recorder_{nullptr};
+    SearchProfile* profile_{nullptr};
+    QueryArena queryArena_;
 };
 
 } // namespace pathcore
@@ -9,12 +9,23 @@ enum class NeighborMode : std::uint8_t {
     Eight
 };
 
+// Full keeps int32 parent/g/f arrays; Compact packs state and a 3-bit parent direction into one
+// byte per cell and drops fScore (f = g + h can be recomputed by the caller).
+enum class SnapshotLayout : std::uint8_t {
+    Full = 0,
+    Compact
+};
+
 struct SearchConfig {
     NeighborMode neighborMode{NeighborMode::Four};
     bool useWeights{false};
     bool allowCornerCutting{false};
     bool penalizeTurns{false};
     int turnPenalty{1};
+    // When false, the found path is only reported through ISearch::path() and the snapshot
+    // keeps its Closed/Open marks (headless callers skip the extra per-cell writes).
+    bool markPath{true};
+    SnapshotLayout snapshotLayout{SnapshotLayout::Full};
 };
 
 } // namespace pathcore
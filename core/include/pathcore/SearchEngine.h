@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "pathcore/ISearch.h"
+#include "pathcore/SearchBase.h"
+
+namespace pathcore {
+
+// ISearch backed by SearchBase: engines derive from this and implement reset() and step(), plus
+// retarget() when they can keep their work. Everything else SearchBase already does is
+// forwarded here once.
+class SearchEngine : public ISearch, public SearchBase {
+public:
+    SearchEngine() = default;
+    explicit SearchEngine(std::pmr::memory_resource* upstream)
+        : SearchBase(upstream) {
+    }
+
+    SearchStatus stepUntil(std::chrono::steady_clock::time_point deadline) override {
+        return stepUntilWith(deadline, [this](std::size_t n) { step(n); });
+    }
+    SearchStatus status() const override {
+        return SearchBase::status();
+    }
+    const SearchSnapshot& snapshot() const override {
+        return SearchBase::snapshot();
+    }
+    const SearchPath& path() const override {
+        return SearchBase::path();
+    }
+    std::uint64_t expansions() const override {
+        return SearchBase::expansions();
+    }
+    void setComponentLabels(const ComponentLabels* labels) override {
+        SearchBase::setComponentLabels(labels);
+    }
+    void setCancelToken(const CancelToken* token) override {
+        SearchBase::setCancelToken(token);
+    }
+    void setWorkspace(SearchWorkspace* workspace) override {
+        SearchBase::setWorkspace(workspace);
+    }
+    void setRecorder(SearchRecorder* recorder) override {
+        SearchBase::setRecorder(recorder);
+    }
+    void setProfile(SearchProfile* profile) override {
+        SearchBase::setProfile(profile);
+    }
+    bool retarget(CellPos goal) override {
+        (void)goal;
+        return false;
+    }
+};
+
+} // namespace pathcore
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+// Result of a finished search: cells ordered from start to goal plus the total path cost.
+// Copies allocate from the default resource, whatever `cells` of the source was built on.
+struct SearchPath {
+    SearchPath() = default;
+    explicit SearchPath(std::pmr::memory_resource* resource)
+        : cells(resource) {
+    }
+
+    std::pmr::vector<CellPos> cells;
+    std::int32_t cost{0};
+    // cost is at most bound times the optimal cost; exact engines always report 1.
+    double bound{1.0};
+
+    bool empty() const {
+        return cells.empty();
+    }
+
+    void clear() {
+        cells.clear();
+        cost = 0;
+        bound = 1.0;
+    }
+};
+
+} // namespace pathcore
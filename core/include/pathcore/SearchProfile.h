@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/IndexMap.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+enum class ProfileCounter : std::uint8_t {
+    ExpansionOrder = 0, // index of the cell's first expansion
+    Expansions,         // more than one means re-expansion
+    Pushes,             // open-list insertions
+    StalePops,          // entries popped after a better one had been handled
+    Reopens             // Closed cells put back on the open list
+};
+
+// Per-cell counters of the work a search did, to see where an engine wastes it. Engines count
+// into it once it is set with ISearch::setProfile (no profile, no counting); every reset()
+// starts over. With turn penalties g depends on the path taken, so cells are often pushed,
+// popped stale and reopened several times.
+class SearchProfile {
+public:
+    static constexpr std::int32_t kNotExpanded = -1;
+
+    void begin(const Grid& grid);
+    void clear();
+    bool valid() const;
+    int width() const;
+    int height() const;
+
+    void countPush(std::int32_t slot) {
+        ++cells_[static_cast<std::size_t>(slot)].pushes;
+        ++totalOf(ProfileCounter::Pushes);
+    }
+    void countStalePop(std::int32_t slot) {
+        ++cells_[static_cast<std::size_t>(slot)].stalePops;
+        ++totalOf(ProfileCounter::StalePops);
+    }
+    void countReopen(std::int32_t slot) {
+        ++cells_[static_cast<std::size_t>(slot)].reopens;
+        ++totalOf(ProfileCounter::Reopens);
+    }
+    void countExpansion(std::int32_t slot) {
+        CellCounters& cell = cells_[static_cast<std::size_t>(slot)];
+        if (cell.firstExpansion == kNotExpanded) {
+            cell.firstExpansion = static_cast<std::int32_t>(totalOf(ProfileCounter::Expansions));
+            ++totalOf(ProfileCounter::ExpansionOrder);
+        }
+        ++cell.expansions;
+        ++totalOf(ProfileCounter::Expansions);
+    }
+
+    // Counter of cell `p`; ExpansionOrder is kNotExpanded for cells never expanded.
+    std::int64_t value(ProfileCounter counter, CellPos p) const;
+    // Largest value over all cells (for scaling heatmaps) and sum over all cells. The
+    // ExpansionOrder total is the number of distinct cells expanded.
+    std::int64_t maxValue(ProfileCounter counter) const;
+    std::uint64_t total(ProfileCounter counter) const;
+
+private:
+    struct CellCounters {
+        std::int32_t firstExpansion{kNotExpanded};
+        std::uint32_t expansions{0};
+        std::uint32_t pushes{0};
+        std::uint32_t stalePops{0};
+        std::uint32_t reopens{0};
+    };
+
+    static std::int64_t read(const CellCounters& cell, ProfileCounter counter);
+    std::uint64_t& totalOf(ProfileCounter counter) {
+        return totals_[static_cast<std::size_t>(counter)];
+    }
+
+    int width_{0};
+    int height_{0};
+    IndexMap padded_;
+    int pad_{0};
+    // By Grid padded slot, like the engines' own arrays.
+    std::vector<CellCounters> cells_;
+    std::uint64_t totals_[5] = {};
+};
+
+} // namespace pathcore
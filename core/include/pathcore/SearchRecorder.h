@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/IndexMap.h"
+#include "pathcore/NodeState.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/SearchSnapshot.h"
+
+namespace pathcore {
+
+struct RecorderOptions {
+    // Once more deltas than this are kept, the oldest keyframe intervals are dropped.
+    std::size_t maxDeltas{1u << 22};
+    // Deltas between keyframes. Raised to twice the grid's slots (a keyframe costs 5 bytes a
+    // slot, so about 2.5 bytes per delta) but kept to half of maxDeltas.
+    std::size_t keyframeInterval{1u << 12};
+};
+
+// Records a search as it runs, so any step of it can be rebuilt afterwards; step N is the
+// search after its first N state changes. Engines log into it once it is set with
+// ISearch::setRecorder, and every reset() starts a new recording. Deltas are grouped behind
+// keyframes of the whole cell state, so reconstruct() copies one keyframe and replays at most
+// one interval of deltas. Buffers are reused from one recording to the next.
+//
+// A delta is a header byte (new state, parent direction, whether g changed), the slot as a
+// varint of its distance from the previous delta's slot, then g as a varint if it changed:
+// 2 to 4 bytes for most steps.
+class SearchRecorder {
+public:
+    static constexpr std::uint8_t kNoParentDir = 0xF;
+
+    explicit SearchRecorder(const RecorderOptions& options = {});
+
+    void begin(const Grid& grid, const SearchConfig& config);
+    void clear();
+
+    // One state change of one cell, as SearchBase::setState saw it; parentDir is the direction
+    // code towards the parent, negative if none.
+    void record(std::int32_t slot, NodeState to, std::int32_t g, int parentDir) {
+        if (segments_.empty() || segments_.back().count >= interval_) {
+            startSegment();
+        }
+        Segment& segment = segments_.back();
+        const std::size_t at = static_cast<std::size_t>(slot);
+        const std::uint8_t dir = static_cast<std::uint8_t>(parentDir < 0 ? kNoParentDir : parentDir);
+        const bool gChanged = g != g_[at];
+        std::uint8_t bytes[11];
+        bytes[0] = static_cast<std::uint8_t>(static_cast<std::uint8_t>(to) | (dir << 2) | (gChanged ? kGChanged : 0));
+        std::uint8_t* end = putVarint(bytes + 1, zigzag(slot - segment.lastSlot));
+        if (gChanged) {
+            end = putVarint(end, static_cast<std::uint32_t>(g));
+        }
+        segment.deltas.insert(segment.deltas.end(), bytes, end);
+        segment.lastSlot = slot;
+        ++segment.count;
+        state_[at] = static_cast<std::uint8_t>(static_cast<std::uint8_t>(to) | (dir << 4));
+        g_[at] = g;
+        ++steps_;
+        ++kept_;
+    }
+
+    bool recording() const;
+    // Steps firstStep() through stepCount() can be rebuilt.
+    std::uint64_t firstStep() const;
+    std::uint64_t stepCount() const;
+    std::size_t memoryBytes() const;
+
+    // Fills `out` with the search as it was after `step` state changes, in the snapshot
+    // layout the search was configured with. f-scores are not recorded and read as kInfScore.
+    bool reconstruct(std::uint64_t step, SearchSnapshot* out) const;
+
+private:
+    static constexpr std::uint8_t kGChanged = 0x40;
+
+    struct Segment {
+        std::uint64_t firstStep{0};
+        // Cell state by padded slot when the segment began: bits 0-1 state, bits 4-7 parent
+        // direction (kNoParentDir if none). Both are empty for a segment starting at step 0,
+        // which begins from a blank grid.
+        std::vector<std::uint8_t> keyState;
+        std::vector<std::int32_t> keyG;
+        std::vector<std::uint8_t> deltas; // encoded as described above
+        std::size_t count{0};
+        std::int32_t lastSlot{0};
+    };
+
+    static std::uint32_t zigzag(std::int32_t v) {
+        return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+    }
+
+    static std::uint8_t* putVarint(std::uint8_t* out, std::uint32_t v) {
+        while (v >= 0x80) {
+            *out++ = static_cast<std::uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        *out++ = static_cast<std::uint8_t>(v);
+        return out;
+    }
+
+    // Applies the first `count` deltas of `segment` on top of its keyframe.
+    static void replay(const Segment& segment, std::size_t count, std::uint8_t* state, std::int32_t* g);
+
+    void startSegment();
+    void recycleAll();
+
+    RecorderOptions options_;
+    std::size_t interval_{1};
+    int width_{0};
+    int height_{0};
+    IndexLayout layout_{IndexLayout::RowMajor};
+    SnapshotLayout snapshotLayout_{SnapshotLayout::Full};
+    IndexMap padded_;
+    int pad_{0};
+    // Current cell state, same encoding as Segment::keyState.
+    std::vector<std::uint8_t> state_;
+    std::vector<std::int32_t> g_;
+    std::deque<Segment> segments_;
+    std::vector<Segment> spare_;
+    std::uint64_t steps_{0};
+    std::size_t kept_{0};
+};
+
+} // namespace pathcore
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "pathcore/Components.h"
+#include "pathcore/Grid.h"
+#include "pathcore/ISearch.h"
+#include "pathcore/PathCache.h"
+#include "pathcore/SearchConfig.h"
+#include "pathcore/SearchPath.h"
+#include "pathcore/SearchStatus.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+struct SearchRequest {
+    CellPos start{};
+    CellPos goal{};
+    SearchConfig config{};
+    // Higher runs first and gets a larger share of each frame.
+    int priority{0};
+};
+
+struct SearchResult {
+    std::uint64_t id{0};
+    // NotStarted: reset() rejected the request (out of bounds or blocked endpoints).
+    SearchStatus status{SearchStatus::NotStarted};
+    SearchPath path{};
+    std::chrono::steady_clock::duration latency{}; // submit() to completion
+    std::chrono::steady_clock::duration queued{};  // submit() to the first slice
+    std::uint32_t frames{0};                       // frames that gave it a slice
+    std::size_t expansions{0};                     // cells its engine expanded
+};
+
+struct FrameBudget {
+    // Zero means no limit; with both limits at zero every search gets one slice.
+    std::size_t expansions{0};
+    std::chrono::steady_clock::duration time{};
+};
+
+struct SchedulerOptions {
+    std::size_t maxInFlight{64};
+    // Smallest step() a search is given, and its share per weight unit without an expansion cap.
+    std::size_t slice{64};
+    // Waiting this many frames adds 1 to a request's priority.
+    std::uint32_t agingFrames{4};
+};
+
+struct SchedulerStats {
+    std::uint64_t submitted{0};
+    std::uint64_t completed{0};
+    std::uint64_t cancelled{0};
+    std::uint64_t rejected{0};
+    std::uint64_t cacheHits{0}; // completed from the PathCache without an engine
+    std::uint64_t frames{0};
+    std::uint64_t expansions{0};
+    std::chrono::steady_clock::duration totalLatency{};
+    std::chrono::steady_clock::duration maxLatency{};
+};
+
+// Runs many path requests against one grid under a per-frame budget. Up to maxInFlight
+// requests hold an engine from a pool of recycled ISearch instances; each frame splits the
+// budget among them by effective priority (priority plus aging), refilling freed slots from the
+// waiting queue. The grid must not change while requests are in flight.
+class SearchScheduler {
+public:
+    using Factory = std::function<std::unique_ptr<ISearch>()>;
+
+    SearchScheduler(const Grid& grid, Factory factory, const SchedulerOptions& options = {});
+
+    // Passed on to every engine (see ISearch::setComponentLabels).
+    void setComponentLabels(const ComponentLabels* labels);
+    // Requests are looked up here before they take an engine, and found paths are stored
+    // (nullptr disables it). The cache may be shared with other schedulers.
+    void setPathCache(PathCache* cache);
+
+    std::uint64_t submit(const SearchRequest& request);
+    // Finishes the request with SearchStatus::Cancelled; false if it is unknown or done.
+    bool cancel(std::uint64_t id);
+    // Returns the expansions done by the searches it stepped.
+    std::size_t runFrame(const FrameBudget& budget);
+    // Requests finished since the previous call, in completion order.
+    std::vector<SearchResult> takeResults();
+
+    std::size_t waitingCount() const;
+    std::size_t inFlightCount() const;
+    const SchedulerStats& stats() const;
+
+private:
+    struct Job {
+        std::uint64_t id{0};
+        SearchRequest request{};
+        std::chrono::steady_clock::time_point submitted{};
+        std::chrono::steady_clock::time_point firstSlice{};
+        std::uint64_t submitFrame{0};
+        std::uint64_t lastFrame{0};
+        std::uint32_t frames{0};
+        std::size_t expansions{0};
+        std::unique_ptr<ISearch> search;
+        bool done{false};
+    };
+
+    double effectivePriority(const Job& job) const;
+    void sortByPriority(std::vector<Job>& jobs) const;
+    void admit(const std::chrono::steady_clock::time_point* deadline);
+    void finish(Job& job, SearchStatus status, const SearchPath* cached = nullptr);
+
+    const Grid* grid_;
+    Factory factory_;
+    SchedulerOptions options_;
+    const ComponentLabels* components_{nullptr};
+    PathCache* cache_{nullptr};
+    std::vector<Job> waiting_;
+    std::vector<Job> running_;
+    std::vector<std::unique_ptr<ISearch>> idle_;
+    std::vector<SearchResult> results_;
+    SchedulerStats stats_{};
+    std::uint64_t nextId_{1};
+    std::uint64_t frame_{0};
+};
+
+} // namespace pathcore
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cassert>
 #include <cstdint>
 #include <cstddef>
 #include <vector>
 
+#include "pathcore/IndexMap.h"
 #include "pathcore/NodeState.h"
+#include "pathcore/SearchConfig.h"
 #include "pathcore/Types.h"
 
 namespace pathcore {
@@ -12,12 +15,21 @@ namespace pathcore {
 struct SearchSnapshot {
     int width{0};
     int height{0};
+    SnapshotLayout layout{SnapshotLayout::Full};
+    // Same cell order as the Grid the search ran on.
+    IndexMap index;
 
+    // Full layout.
     std::vector<NodeState> state;
     std::vector<std::int32_t> parent;
-    std::vector<std::int32_t> gScore;
     std::vector<std::int32_t> fScore;
 
+    // Compact layout: bits 0-1 state, bit 2 has-parent, bits 3-5 parent direction.
+    std::vector<std::uint8_t> packed;
+
+    // Both layouts.
+    std::vector<std::int32_t> gScore;
+
     static constexpr std::int32_t kNoParent = -1;
     static constexpr std::int32_t kInfScore = 1'000'000'000;
 
@@ -25,26 +37,54 @@ struct SearchSnapshot {
         return width * height;
     }
 
+    int storageSize() const {
+        return index.storageSize();
+    }
+
+    bool compact() const {
+        return layout == SnapshotLayout::Compact;
+    }
+
+    bool hasFScore() const {
+        return layout == SnapshotLayout::Full;
+    }
+
     bool valid() const {
         if (width <= 0 || height <= 0) {
             return false;
         }
-        const std::size_t expected = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+        const std::size_t expected = static_cast<std::size_t>(storageSize());
+        if (compact()) {
+            return packed.size() == expected && gScore.size() == expected;
+        }
         return state.size() == expected && parent.size() == expected && gScore.size() == expected
             && fScore.size() == expected;
     }
 
-    void resize(int w, int h) {
+    void resize(int w, int h, SnapshotLayout l = SnapshotLayout::Full,
+                IndexLayout order = IndexLayout::RowMajor) {
         width = w;
         height = h;
+        index = IndexMap(w, h, order);
         std::size_t total = 0;
         if (w > 0 && h > 0) {
-            total = static_cast<std::size_t>(w) * static_cast<std::size_t>(h);
+            total = static_cast<std::size_t>(index.storageSize());
+        }
+        if (l != layout) {
+            layout = l;
+            state = {};
+            parent = {};
+            fScore = {};
+            packed = {};
+        }
+        if (compact()) {
+            packed.resize(total);
+        } else {
+            state.resize(total);
+            parent.resize(total);
+            fScore.resize(total);
         }
-        state.resize(total);
-        parent.resize(total);
         gScore.resize(total);
-        fScore.resize(total);
         clear();
     }
 
@@ -55,14 +95,99 @@ struct SearchSnapshot {
         for (auto& value : parent) {
             value = kNoParent;
         }
-        for (auto& value : gScore) {
+        for (auto& value : fScore) {
             value = kInfScore;
         }
-        for (auto& value : fScore) {
+        for (auto& value : packed) {
+            value = 0;
+        }
+        for (auto& value : gScore) {
             value = kInfScore;
         }
     }
 
+    NodeState stateAt(std::int32_t idx) const {
+        const std::size_t i = static_cast<std::size_t>(idx);
+        if (compact()) {
+            return static_cast<NodeState>(packed[i] & 0x3u);
+        }
+        return state[i];
+    }
+
+    void setStateAt(std::int32_t idx, NodeState s) {
+        const std::size_t i = static_cast<std::size_t>(idx);
+        if (compact()) {
+            packed[i] = static_cast<std::uint8_t>((packed[i] & ~0x3u) | static_cast<std::uint8_t>(s));
+            return;
+        }
+        state[i] = s;
+    }
+
+    std::int32_t parentAt(std::int32_t idx) const {
+        const std::size_t i = static_cast<std::size_t>(idx);
+        if (!compact()) {
+            return parent[i];
+        }
+        if ((packed[i] & 0x4u) == 0) {
+            return kNoParent;
+        }
+        const int dir = (packed[i] >> 3) & 0x7;
+        const CellPos p = index.fromIndex(idx);
+        return static_cast<std::int32_t>(index.toIndex(CellPos{p.x + kDirDx[dir], p.y + kDirDy[dir]}));
+    }
+
+    void setParentAt(std::int32_t idx, std::int32_t parentIndex) {
+        const std::size_t i = static_cast<std::size_t>(idx);
+        if (!compact()) {
+            parent[i] = parentIndex;
+            return;
+        }
+        std::uint8_t bits = static_cast<std::uint8_t>(packed[i] & 0x3u);
+        if (parentIndex != kNoParent) {
+            const int dir = directionCode(index.fromIndex(idx), index.fromIndex(parentIndex));
+            assert(dir >= 0 && "Compact snapshots only store neighboring parents");
+            if (dir >= 0) {
+                bits = static_cast<std::uint8_t>(bits | 0x4u | (dir << 3));
+            }
+        }
+        packed[i] = bits;
+    }
+
+    std::int32_t gAt(std::int32_t idx) const {
+        return gScore[static_cast<std::size_t>(idx)];
+    }
+
+    void setGAt(std::int32_t idx, std::int32_t g) {
+        gScore[static_cast<std::size_t>(idx)] = g;
+    }
+
+    // Compact snapshots do not keep f; callers recompute it as g + h.
+    std::int32_t fAt(std::int32_t idx) const {
+        if (compact()) {
+            return kInfScore;
+        }
+        return fScore[static_cast<std::size_t>(idx)];
+    }
+
+    void setFAt(std::int32_t idx, std::int32_t f) {
+        if (compact()) {
+            return;
+        }
+        fScore[static_cast<std::size_t>(idx)] = f;
+    }
+
+    // Returns the 0..7 code of the step from `from` to `to`, or -1 if they are not neighbors.
+    static int directionCode(CellPos from, CellPos to) {
+        const int dx = to.x - from.x;
+        const int dy = to.y - from.y;
+        for (int dir = 0; dir < 8; ++dir) {
+            if (kDirDx[dir] == dx && kDirDy[dir] == dy) {
+                return dir;
+            }
+        }
+        return -1;
+    }
+
     bool inBounds(CellPos p) const {
         return pathcore::inBounds(width, height, p);
     }
@@ -71,23 +196,21 @@ struct SearchSnapshot {
         if (!inBounds(p)) {
             return -1;
         }
-        return static_cast<std::int32_t>(pathcore::toIndex(width, p));
+        return static_cast<std::int32_t>(index.toIndex(p));
     }
 
     NodeState getState(CellPos p) const {
         if (!inBounds(p)) {
             return NodeState::Unseen;
         }
-        const std::size_t idx = static_cast<std::size_t>(pathcore::toIndex(width, p));
-        return state[idx];
+        return stateAt(static_cast<std::int32_t>(index.toIndex(p)));
     }
 
     bool setState(CellPos p, NodeState s) {
         if (!inBounds(p)) {
             return false;
         }
-        const std::size_t idx = static_cast<std::size_t>(pathcore::toIndex(width, p));
-        state[idx] = s;
+        setStateAt(static_cast<std::int32_t>(index.toIndex(p)), s);
         return true;
     }
 
@@ -95,8 +218,7 @@ struct SearchSnapshot {
         if (!inBounds(p)) {
             return false;
         }
-        const std::size_t idx = static_cast<std::size_t>(pathcore::toIndex(width, p));
-        parent[idx] = parentIndex;
+        setParentAt(static_cast<std::int32_t>(index.toIndex(p)), parentIndex);
         return true;
     }
 };
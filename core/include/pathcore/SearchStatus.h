@@ -8,7 +8,9 @@ enum class SearchStatus : std::uint8_t {
     NotStarted = 0,
     Running,
     Found,
-    NoPath
+    NoPath,
+    // Stopped through a CancelToken; reset() starts over.
+    Cancelled
 };
 
 } // namespace pathcore
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+namespace pathcore {
+
+class CoroutineSearch;
+
+// Coroutine type for engines written as one loop instead of a resumable step(): the body
+// co_yields the number of expansions done since the previous yield (normally 1) and its locals
+// survive between resumes. Starts suspended; see CoroutineSearch for the ISearch adapter.
+class SearchTask {
+public:
+    struct promise_type {
+        std::size_t expanded{0};
+
+        // Frames of CoroutineSearch members (the engine is their first argument) come from the
+        // engine's query arena, so warm queries do not allocate; other coroutines use the heap.
+        static void* operator new(std::size_t size, CoroutineSearch& engine);
+        static void* operator new(std::size_t size);
+        static void operator delete(void* frame, std::size_t size);
+
+        SearchTask get_return_object() {
+            return SearchTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always yield_value(std::size_t count) noexcept {
+            expanded = count;
+            return {};
+        }
+        void return_void() noexcept {
+            expanded = 0;
+        }
+        // pathcore does not throw; an escaping exception is a bug.
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    SearchTask() = default;
+    SearchTask(const SearchTask&) = delete;
+    SearchTask& operator=(const SearchTask&) = delete;
+
+    SearchTask(SearchTask&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+
+    SearchTask& operator=(SearchTask&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~SearchTask() {
+        destroy();
+    }
+
+    bool valid() const {
+        return static_cast<bool>(handle_);
+    }
+
+    bool done() const {
+        return !handle_ || handle_.done();
+    }
+
+    // Runs the body up to its next co_yield; returns false once it has finished.
+    bool resume() {
+        if (done()) {
+            return false;
+        }
+        handle_.resume();
+        return !handle_.done();
+    }
+
+    // Expansions reported by the last co_yield.
+    std::size_t expanded() const {
+        return handle_ ? handle_.promise().expanded : 0;
+    }
+
+private:
+    explicit SearchTask(std::coroutine_handle<promise_type> handle)
+        : handle_(handle) {
+    }
+
+    void destroy() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_{};
+};
+
+} // namespace pathcore
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "pathcore/SearchBase.h"
+#include "pathcore/SearchPath.h"
+#include "pathcore/SearchSnapshot.h"
+
+namespace pathcore {
+
+// Search buffers that outlive engines: hand one to each new engine (ISearch::setWorkspace) and
+// repeated queries or algorithm switches on the same grid size stop allocating once it is warm.
+// It must outlive the engines it is lent to. The buffers live on the default resource; an
+// engine built on another upstream copies instead of swapping.
+class SearchWorkspace {
+public:
+    SearchWorkspace() = default;
+    SearchWorkspace(const SearchWorkspace&) = delete;
+    SearchWorkspace& operator=(const SearchWorkspace&) = delete;
+
+    // Bytes reserved by the buffers currently stored here (zero while lent out).
+    std::size_t capacityBytes() const;
+    // Frees everything; not allowed while an engine holds the buffers.
+    void release();
+
+private:
+    friend class SearchBase;
+
+    std::pmr::vector<SearchBase::HotNode> hot_;
+    std::pmr::vector<SearchBase::OpenEntry> open_;
+    std::pmr::vector<std::int32_t> dirty_;
+    SearchSnapshot snapshot_{};
+    SearchPath path_{};
+    bool lent_{false};
+};
+
+} // namespace pathcore
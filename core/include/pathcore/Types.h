@@ -26,6 +26,10 @@ inline CellPos fromIndex(int width, int idx) {
     return CellPos{idx % width, idx / width};
 }
 
+// Neighbor direction codes 0..7, clockwise from +x with y growing downwards.
+inline constexpr int kDirDx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+inline constexpr int kDirDy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
 inline bool inBounds(int width, int height, CellPos p) {
     return width > 0 && height > 0 && p.x >= 0 && p.y >= 0 && p.x < width && p.y < height;
 }
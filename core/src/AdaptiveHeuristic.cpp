@@ -0,0 +1,214 @@
+#include "pathcore/AdaptiveHeuristic.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+#include "pathcore/SearchSnapshot.h"
+
+namespace pathcore {
+namespace {
+
+constexpr int kBoundExpansions = 512;
+
+// Cost of a cheapest path from `from` to `to`, or -1 when none is found within a small number
+// of expansions (goals of one region are close, so this is usually a few dozen cells).
+std::int32_t boundedCost(const Grid& grid, const SearchConfig& config, CellPos from, CellPos to) {
+    const std::int32_t* costs = grid.paddedCosts();
+    const std::int32_t source = grid.paddedIndex(from);
+    const std::int32_t target = grid.paddedIndex(to);
+    // A typical probe fits in the stack buffer; bigger ones spill to the default resource.
+    std::array<std::byte, 16 * 1024> scratch;
+    std::pmr::monotonic_buffer_resource arena(scratch.data(), scratch.size());
+    // slot -> dist, only cells touched
+    std::pmr::unordered_map<std::int32_t, std::int32_t> best(&arena);
+    auto distOf = [&best](std::int32_t slot) {
+        const auto it = best.find(slot);
+        return it == best.end() ? SearchSnapshot::kInfScore : it->second;
+    };
+
+    using Item = std::pair<std::int32_t, std::int32_t>; // (dist, slot)
+    std::priority_queue<Item, std::pmr::vector<Item>, std::greater<Item>> open(
+        std::greater<Item>{}, std::pmr::vector<Item>(&arena));
+    best[source] = 0;
+    open.push(Item{0, source});
+    const bool eightWay = config.neighborMode == NeighborMode::Eight;
+    for (int expansions = 0; !open.empty() && expansions < kBoundExpansions; ++expansions) {
+        const Item current = open.top();
+        open.pop();
+        if (current.first != distOf(current.second)) {
+            continue;
+        }
+        if (current.second == target) {
+            return current.first;
+        }
+        const int* deltas = grid.neighborDeltas(current.second);
+        for (int dir = 0; dir < 8; ++dir) {
+            const bool diagonal = (dir & 1) != 0;
+            if (diagonal && !eightWay) {
+                continue;
+            }
+            const std::int32_t n = current.second + deltas[dir];
+            if (costs[n] == 0) {
+                continue;
+            }
+            if (diagonal && !config.allowCornerCutting
+                && (costs[current.second + deltas[(dir + 7) & 7]] == 0
+                    || costs[current.second + deltas[(dir + 1) & 7]] == 0)) {
+                continue;
+            }
+            const std::int32_t nd = current.first + (config.useWeights ? costs[n] : 1);
+            if (nd < distOf(n)) {
+                best[n] = nd;
+                open.push(Item{nd, n});
+            }
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+AdaptiveHeuristic::AdaptiveHeuristic(int regionSize, std::size_t maxEntries)
+    : regionSize_(std::max(1, regionSize))
+    , maxEntries_(std::max<std::size_t>(1, maxEntries)) {}
+
+void AdaptiveHeuristic::clear() {
+    entries_.clear();
+    active_ = nullptr;
+    offset_ = 0;
+    width_ = 0;
+    height_ = 0;
+}
+
+const AdaptiveHeuristicStats& AdaptiveHeuristic::stats() const {
+    return stats_;
+}
+
+void AdaptiveHeuristic::resetStats() {
+    stats_ = AdaptiveHeuristicStats{};
+}
+
+bool AdaptiveHeuristic::prepare(const Grid& grid, CellPos goal, const SearchConfig& config) {
+    active_ = nullptr;
+    offset_ = 0;
+    preparedGoal_ = goal;
+    if (config.penalizeTurns) {
+        return false;
+    }
+    ++stats_.queries;
+
+    const bool sameRules = config.neighborMode == config_.neighborMode && config.useWeights == config_.useWeights
+        && config.allowCornerCutting == config_.allowCornerCutting;
+    if (grid.width() != width_ || grid.height() != height_ || grid.layout() != layout_ || !sameRules
+        || grid.version() != gridVersion_) {
+        clear();
+        gridVersion_ = grid.version();
+        width_ = grid.width();
+        height_ = grid.height();
+        layout_ = grid.layout();
+        config_ = config;
+    }
+
+    // Even on a miss the search goes through the provider, so learn() can fill the cache.
+    Entry* entry = findEntry(goal);
+    if (entry == nullptr) {
+        ++stats_.misses;
+        return true;
+    }
+    if (entry->goal == goal) {
+        ++stats_.exactHits;
+    } else {
+        const std::int32_t bound = boundedCost(grid, config_, goal, entry->goal);
+        if (bound < 0) {
+            ++stats_.misses;
+            return true;
+        }
+        ++stats_.regionHits;
+        offset_ = bound;
+    }
+    entry->lastUsed = ++clock_;
+    active_ = entry;
+    return true;
+}
+
+std::int32_t AdaptiveHeuristic::estimate(CellPos p, std::int32_t slot) const {
+    (void)p;
+    ++stats_.estimates;
+    if (active_ == nullptr) {
+        return 0;
+    }
+    const std::int32_t learned = active_->h[static_cast<std::size_t>(slot)];
+    if (learned < 0) {
+        return 0;
+    }
+    ++stats_.informedEstimates;
+    return std::max(0, learned - offset_);
+}
+
+void AdaptiveHeuristic::learn(const Grid& grid, CellPos goal, std::int32_t goalCost,
+    const std::vector<SettledCell>& settled) {
+    if (goal != preparedGoal_ || grid.width() != width_ || grid.height() != height_
+        || grid.version() != gridVersion_) {
+        return;
+    }
+
+    Entry& entry = entryFor(goal);
+    if (entry.goal != goal) {
+        // Re-key the region to the new goal. Shifted values stay valid for it when prepare()
+        // found a bound; otherwise the old goal's values are dropped.
+        for (std::int32_t& h : entry.h) {
+            if (h >= 0) {
+                h = &entry == active_ ? std::max(0, h - offset_) : -1;
+            }
+        }
+        entry.goal = goal;
+    }
+    if (entry.h.empty()) {
+        entry.h.assign(static_cast<std::size_t>(grid.paddedStorageSize()), -1);
+    }
+    for (const SettledCell& cell : settled) {
+        const std::int32_t h = goalCost - cell.g;
+        std::int32_t& stored = entry.h[static_cast<std::size_t>(cell.slot)];
+        if (h > stored) {
+            stored = h;
+            ++stats_.learnedCells;
+        }
+    }
+    active_ = nullptr;
+}
+
+AdaptiveHeuristic::Entry* AdaptiveHeuristic::findEntry(CellPos goal) {
+    const int rx = goal.x / regionSize_;
+    const int ry = goal.y / regionSize_;
+    for (Entry& entry : entries_) {
+        if (entry.goal.x / regionSize_ == rx && entry.goal.y / regionSize_ == ry) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+AdaptiveHeuristic::Entry& AdaptiveHeuristic::entryFor(CellPos goal) {
+    Entry* entry = findEntry(goal);
+    if (entry != nullptr) {
+        entry->lastUsed = ++clock_;
+        return *entry;
+    }
+    if (entries_.size() < maxEntries_) {
+        entries_.push_back(Entry{goal, {}, ++clock_});
+        return entries_.back();
+    }
+    // Evict the least recently used region.
+    Entry& oldest = *std::min_element(entries_.begin(), entries_.end(),
+        [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+    oldest = Entry{goal, {}, ++clock_};
+    return oldest;
+}
+
+} // namespace pathcore
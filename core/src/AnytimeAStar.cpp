@@ -0,0 +1,451 @@
+#include "pathcore/AnytimeAStar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+#include "pathcore/Grid.h"
+#include "pathcore/NodeState.h"
+#include "pathcore/SearchSnapshot.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+namespace {
+
+constexpr std::uint8_t kNotQueued = 0;
+constexpr std::uint8_t kInOpen = 1;
+constexpr std::uint8_t kInIncons = 2;
+
+} // namespace
+
+AnytimeAStar::AnytimeAStar(const AnytimeOptions& options, std::pmr::memory_resource* upstream)
+    : SearchEngine(upstream)
+    , options_(options)
+    , araOpen_(upstream)
+    , araNext_(upstream)
+    , closedIn_(upstream)
+    , queued_(upstream)
+    , incons_(upstream)
+    , f_(upstream)
+    , openByF_(queryMemory())
+    , focal_(queryMemory()) {
+    fScores_ = &f_;
+}
+
+void AnytimeAStar::setOptions(const AnytimeOptions& options) {
+    options_ = options;
+}
+
+const AnytimeOptions& AnytimeAStar::options() const {
+    return options_;
+}
+
+double AnytimeAStar::weight() const {
+    return weight_;
+}
+
+int AnytimeAStar::solutionCount() const {
+    return solutions_;
+}
+
+std::int32_t AnytimeAStar::heuristic(CellPos a, CellPos b, NeighborMode mode) {
+    const int dx = std::abs(a.x - b.x);
+    const int dy = std::abs(a.y - b.y);
+    if (mode == NeighborMode::Eight) {
+        return static_cast<std::int32_t>(std::max(dx, dy));
+    }
+    return static_cast<std::int32_t>(dx + dy);
+}
+
+double AnytimeAStar::araKey(std::int32_t idx) const {
+    const std::int32_t g = hot_[static_cast<std::size_t>(idx)].g;
+    const std::int32_t h = f_[static_cast<std::size_t>(idx)] - g;
+    return static_cast<double>(g) + weight_ * static_cast<double>(h);
+}
+
+bool AnytimeAStar::deadlinePassed() const {
+    if (solutions_ == 0 || active_.deadline <= std::chrono::steady_clock::duration::zero()) {
+        return false;
+    }
+    return std::chrono::steady_clock::now() >= deadlineAt_;
+}
+
+bool AnytimeAStar::reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) {
+    solutions_ = 0;
+    // The focal sets live in the query arena that commonReset releases.
+    openByF_.clear();
+    focal_.clear();
+    if (!commonReset(grid, start, goal, config)) {
+        return false;
+    }
+
+    active_ = options_;
+    if (!(active_.initialWeight >= 1.0)) {
+        active_.initialWeight = 1.0;
+    }
+    weight_ = active_.initialWeight;
+    deadlineAt_ = std::chrono::steady_clock::now() + active_.deadline;
+    startIdx_ = static_cast<std::int32_t>(grid.paddedIndex(start));
+    goalIdx_ = static_cast<std::int32_t>(grid.paddedIndex(goal));
+
+    const std::size_t total = hot_.size();
+    araOpen_.clear();
+    incons_.clear();
+    closedIn_.assign(total, 0);
+    queued_.assign(total, kNotQueued);
+    f_.assign(total, SearchSnapshot::kInfScore);
+    pass_ = 1;
+    focalLimit_ = 0.0;
+    incumbent_ = SearchSnapshot::kInfScore;
+
+    const std::int32_t hStart = heuristic(start, goal, config.neighborMode);
+    hot_[static_cast<std::size_t>(startIdx_)].g = 0;
+    f_[static_cast<std::size_t>(startIdx_)] = hStart;
+    if (active_.variant == AnytimeVariant::Focal) {
+        openFocal(startIdx_, 0, hStart);
+        refillFocal(true);
+    } else {
+        setState(startIdx_, NodeState::Open);
+        queued_[static_cast<std::size_t>(startIdx_)] = kInOpen;
+        araOpen_.push_back(QueueItem{araKey(startIdx_), 0, startIdx_});
+        profilePush(startIdx_);
+    }
+    return true;
+}
+
+SearchStatus AnytimeAStar::step(std::size_t iterations) {
+    if (status_ != SearchStatus::Running || cancelRequested()) {
+        return status_;
+    }
+    if (deadlinePassed()) {
+        status_ = SearchStatus::Found;
+        return status_;
+    }
+    return active_.variant == AnytimeVariant::Focal ? stepFocal(iterations) : stepAra(iterations);
+}
+
+template <typename OnImproved>
+void AnytimeAStar::relaxNeighbors(std::int32_t idx, OnImproved&& onImproved) {
+    const std::int32_t* costs = grid().paddedCosts();
+    const bool eightWay = config_.neighborMode == NeighborMode::Eight;
+    const int* dirs = eightWay ? kEightDirs : kFourDirs;
+    const int dirCount = eightWay ? 8 : 4;
+
+    const HotNode& node = hot_[static_cast<std::size_t>(idx)];
+    const std::int32_t g = node.g;
+    const std::uint8_t prevDir = node.dir;
+    const CellPos pos = grid().fromPaddedIndex(idx);
+    const int* deltas = grid().neighborDeltas(idx);
+    for (int k = 0; k < dirCount; ++k) {
+        const int dir = dirs[k];
+        const std::int32_t nIdx = idx + deltas[dir];
+        const std::int32_t cellCost = costs[nIdx];
+        if (cellCost == 0) {
+            continue;
+        }
+        if ((dir & 1) != 0 && !config_.allowCornerCutting) {
+            if (costs[idx + deltas[kDiagAdjX[dir]]] == 0 || costs[idx + deltas[kDiagAdjY[dir]]] == 0) {
+                continue;
+            }
+        }
+
+        const std::int32_t stepCost = config_.useWeights ? cellCost : 1;
+        std::int32_t turnPenalty = 0;
+        if (config_.penalizeTurns && prevDir != kNoDir && config_.turnPenalty > 0 && dir != prevDir) {
+            turnPenalty = config_.turnPenalty;
+        }
+        const std::int32_t newG = g + stepCost + turnPenalty;
+
+        HotNode& next = hot_[static_cast<std::size_t>(nIdx)];
+        if (newG >= next.g) {
+            continue;
+        }
+        const std::int32_t oldG = next.g;
+        const std::int32_t oldF = f_[static_cast<std::size_t>(nIdx)];
+        next.g = newG;
+        next.dir = static_cast<std::uint8_t>(dir);
+        const CellPos neighbor{pos.x + kDirDx[dir], pos.y + kDirDy[dir]};
+        const std::int32_t h = heuristic(neighbor, goal_, config_.neighborMode);
+        f_[static_cast<std::size_t>(nIdx)] = newG + h;
+        onImproved(nIdx, oldG, oldF);
+    }
+}
+
+void AnytimeAStar::publishPath(double bound) {
+    clearPathMarks();
+    rebuildPath(startIdx_, goalIdx_);
+    // A cell improved after its children were relaxed leaves their g too high until it is
+    // expanded again, so the walk along the parents can cost less than g(goal).
+    const std::int32_t* costs = grid().paddedCosts();
+    std::int32_t cost = 0;
+    std::uint8_t prevDir = kNoDir;
+    for (std::size_t i = 1; i < path_.cells.size(); ++i) {
+        const std::int32_t slot = static_cast<std::int32_t>(grid().paddedIndex(path_.cells[i]));
+        const std::uint8_t dir = hot_[static_cast<std::size_t>(slot)].dir;
+        cost += config_.useWeights ? costs[slot] : 1;
+        if (config_.penalizeTurns && prevDir != kNoDir && config_.turnPenalty > 0 && dir != prevDir) {
+            cost += config_.turnPenalty;
+        }
+        prevDir = dir;
+    }
+    if (!path_.cells.empty()) {
+        path_.cost = cost;
+    }
+    path_.bound = bound;
+    ++solutions_;
+}
+
+SearchStatus AnytimeAStar::stepAra(std::size_t iterations) {
+    const QueueItemCompare compare{};
+    std::size_t expansions = 0;
+    while (expansions < iterations) {
+        while (!araOpen_.empty()) {
+            const QueueItem& top = araOpen_.front();
+            if (queued_[static_cast<std::size_t>(top.idx)] == kInOpen
+                && hot_[static_cast<std::size_t>(top.idx)].g == top.g) {
+                break;
+            }
+            profileStalePop(top.idx);
+            std::pop_heap(araOpen_.begin(), araOpen_.end(), compare);
+            araOpen_.pop_back();
+        }
+
+        // The pass ends once no open cell can lead to a cheaper goal under the current weight.
+        const std::int32_t goalG = hot_[static_cast<std::size_t>(goalIdx_)].g;
+        if (araOpen_.empty() || static_cast<double>(goalG) <= araOpen_.front().key) {
+            finishAraPass();
+            if (status_ != SearchStatus::Running) {
+                return status_;
+            }
+            continue;
+        }
+
+        const std::int32_t idx = araOpen_.front().idx;
+        std::pop_heap(araOpen_.begin(), araOpen_.end(), compare);
+        araOpen_.pop_back();
+        queued_[static_cast<std::size_t>(idx)] = kNotQueued;
+        closedIn_[static_cast<std::size_t>(idx)] = pass_;
+        setState(idx, NodeState::Closed);
+        profileExpansion(idx);
+        ++expansions;
+
+        relaxNeighbors(idx, [&](std::int32_t nIdx, std::int32_t, std::int32_t) {
+            const std::size_t n = static_cast<std::size_t>(nIdx);
+            if (closedIn_[n] == pass_) {
+                // Not re-expanded in this pass; the next one starts from it.
+                touchCell(nIdx);
+                if (queued_[n] != kInIncons) {
+                    queued_[n] = kInIncons;
+                    incons_.push_back(nIdx);
+                }
+                return;
+            }
+            queued_[n] = kInOpen;
+            setState(nIdx, NodeState::Open);
+            araOpen_.push_back(QueueItem{araKey(nIdx), hot_[n].g, nIdx});
+            std::push_heap(araOpen_.begin(), araOpen_.end(), compare);
+            profilePush(nIdx);
+        });
+
+        if (expansions % kCheckStride == 0) {
+            if (cancelRequested()) {
+                return status_;
+            }
+            if (deadlinePassed()) {
+                status_ = SearchStatus::Found;
+                return status_;
+            }
+        }
+    }
+    return status_;
+}
+
+void AnytimeAStar::finishAraPass() {
+    const std::int32_t goalG = hot_[static_cast<std::size_t>(goalIdx_)].g;
+    if (goalG == SearchSnapshot::kInfScore) {
+        status_ = SearchStatus::NoPath;
+        return;
+    }
+
+    // Every cell whose g may still be too high is in OPEN or INCONS, so their smallest
+    // unweighted f bounds the optimal cost from below.
+    std::int32_t lower = goalG;
+    for (const QueueItem& item : araOpen_) {
+        const std::size_t i = static_cast<std::size_t>(item.idx);
+        if (queued_[i] == kInOpen && hot_[i].g == item.g) {
+            lower = std::min(lower, f_[i]);
+        }
+    }
+    for (const std::int32_t idx : incons_) {
+        lower = std::min(lower, f_[static_cast<std::size_t>(idx)]);
+    }
+    const double bound = lower > 0
+        ? std::min(weight_, static_cast<double>(goalG) / static_cast<double>(lower))
+        : 1.0;
+    publishPath(bound);
+
+    if (bound <= 1.0 || deadlinePassed()) {
+        status_ = SearchStatus::Found;
+        return;
+    }
+    weight_ = active_.weightStep > 0.0 ? std::max(1.0, weight_ - active_.weightStep) : 1.0;
+    ++pass_;
+    rebuildAraOpen();
+}
+
+void AnytimeAStar::rebuildAraOpen() {
+    araNext_.clear();
+    for (const QueueItem& item : araOpen_) {
+        const std::size_t i = static_cast<std::size_t>(item.idx);
+        if (queued_[i] == kInOpen && hot_[i].g == item.g) {
+            araNext_.push_back(QueueItem{araKey(item.idx), item.g, item.idx});
+        }
+    }
+    for (const std::int32_t idx : incons_) {
+        const std::size_t i = static_cast<std::size_t>(idx);
+        queued_[i] = kInOpen;
+        setState(idx, NodeState::Open);
+        araNext_.push_back(QueueItem{araKey(idx), hot_[i].g, idx});
+        profilePush(idx);
+    }
+    incons_.clear();
+    araOpen_.swap(araNext_);
+    std::make_heap(araOpen_.begin(), araOpen_.end(), QueueItemCompare{});
+}
+
+void AnytimeAStar::openFocal(std::int32_t idx, std::int32_t g, std::int32_t f) {
+    openByF_.insert(RankedCell{f, -g, idx});
+    queued_[static_cast<std::size_t>(idx)] = kInOpen;
+    setState(idx, NodeState::Open);
+    profilePush(idx);
+    if (static_cast<double>(f) <= focalLimit_) {
+        focal_.insert(RankedCell{f - g, f, idx});
+    }
+}
+
+void AnytimeAStar::closeFocal(std::int32_t idx) {
+    const std::size_t i = static_cast<std::size_t>(idx);
+    const std::int32_t g = hot_[i].g;
+    const std::int32_t f = f_[i];
+    openByF_.erase(RankedCell{f, -g, idx});
+    focal_.erase(RankedCell{f - g, f, idx});
+    queued_[i] = kNotQueued;
+}
+
+// Keeps focal_ equal to the open cells with f <= weight * min f. min f only grows while the
+// weight is fixed, so normally the cells between the old and the new limit are added.
+void AnytimeAStar::refillFocal(bool rebuild) {
+    if (openByF_.empty()) {
+        focal_.clear();
+        focalLimit_ = 0.0;
+        return;
+    }
+    const double limit = weight_ * static_cast<double>(openByF_.begin()->primary);
+    if (limit < focalLimit_) {
+        rebuild = true;
+    }
+    auto it = openByF_.begin();
+    if (rebuild) {
+        focal_.clear();
+    } else {
+        const double from = std::min(std::floor(focalLimit_) + 1.0,
+            static_cast<double>(std::numeric_limits<std::int32_t>::max()));
+        it = openByF_.lower_bound(RankedCell{static_cast<std::int32_t>(from),
+            std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::min()});
+    }
+    for (; it != openByF_.end() && static_cast<double>(it->primary) <= limit; ++it) {
+        focal_.insert(RankedCell{it->primary + it->secondary, it->primary, it->idx});
+    }
+    focalLimit_ = limit;
+}
+
+SearchStatus AnytimeAStar::stepFocal(std::size_t iterations) {
+    std::size_t expansions = 0;
+    while (expansions < iterations) {
+        if (focal_.empty()) {
+            if (openByF_.empty()) {
+                // Nothing left that could beat the incumbent: it is optimal.
+                if (solutions_ > 0) {
+                    path_.bound = 1.0;
+                    status_ = SearchStatus::Found;
+                } else {
+                    status_ = SearchStatus::NoPath;
+                }
+                return status_;
+            }
+            refillFocal(true);
+        }
+
+        const std::int32_t idx = focal_.begin()->idx;
+        closeFocal(idx);
+        if (idx == goalIdx_) {
+            incumbent_ = hot_[static_cast<std::size_t>(goalIdx_)].g;
+            finishFocalSolution();
+            if (status_ != SearchStatus::Running) {
+                return status_;
+            }
+            continue;
+        }
+        setState(idx, NodeState::Closed);
+        profileExpansion(idx);
+        ++expansions;
+
+        // Closed cells are reopened when improved, which keeps min f a lower bound on the
+        // optimal cost.
+        relaxNeighbors(idx, [&](std::int32_t nIdx, std::int32_t oldG, std::int32_t oldF) {
+            const std::size_t n = static_cast<std::size_t>(nIdx);
+            if (queued_[n] == kInOpen) {
+                openByF_.erase(RankedCell{oldF, -oldG, nIdx});
+                focal_.erase(RankedCell{oldF - oldG, oldF, nIdx});
+                queued_[n] = kNotQueued;
+            }
+            const std::int32_t f = f_[n];
+            if (f >= incumbent_) {
+                touchCell(nIdx);
+                return;
+            }
+            openFocal(nIdx, hot_[n].g, f);
+        });
+        refillFocal(false);
+
+        if (expansions % kCheckStride == 0) {
+            if (cancelRequested()) {
+                return status_;
+            }
+            if (deadlinePassed()) {
+                status_ = SearchStatus::Found;
+                return status_;
+            }
+        }
+    }
+    return status_;
+}
+
+void AnytimeAStar::finishFocalSolution() {
+    // Open cells with f >= incumbent cannot lead to a cheaper path.
+    const auto cut = openByF_.lower_bound(RankedCell{incumbent_,
+        std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::min()});
+    for (auto it = cut; it != openByF_.end(); ++it) {
+        queued_[static_cast<std::size_t>(it->idx)] = kNotQueued;
+        focal_.erase(RankedCell{it->primary + it->secondary, it->primary, it->idx});
+    }
+    openByF_.erase(cut, openByF_.end());
+
+    const std::int32_t lower =
+        openByF_.empty() ? incumbent_ : std::min(incumbent_, openByF_.begin()->primary);
+    const double bound =
+        lower > 0 ? static_cast<double>(incumbent_) / static_cast<double>(lower) : 1.0;
+    publishPath(bound);
+
+    if (bound <= 1.0 || deadlinePassed()) {
+        status_ = SearchStatus::Found;
+        return;
+    }
+    weight_ = active_.weightStep > 0.0 ? std::max(1.0, weight_ - active_.weightStep) : 1.0;
+    refillFocal(true);
+}
+
+} // namespace pathcore
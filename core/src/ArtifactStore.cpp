@@ -0,0 +1,285 @@
+#include "pathcore/ArtifactStore.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace pathcore {
+namespace {
+
+constexpr char kMagic[8] = {'P', 'V', 'C', 'A', 'R', 'T', '\0', '\0'};
+constexpr std::uint32_t kFormatVersion = 1;
+constexpr std::size_t kKindBytes = 16;
+
+// The payload follows the header, so the header size keeps it 8-byte aligned.
+struct ArtifactHeader {
+    char magic[8];
+    std::uint32_t formatVersion;
+    std::uint32_t kindVersion;
+    char kind[kKindBytes];
+    std::uint64_t contentHash; // Grid::contentHash()
+    std::uint64_t params;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint64_t payloadBytes;
+};
+static_assert(sizeof(ArtifactHeader) % 8 == 0);
+
+bool setError(ArtifactError* err, const std::string& message) {
+    if (err) {
+        err->message = message;
+    }
+    return false;
+}
+
+bool validKind(const std::string& kind) {
+    if (kind.empty() || kind.size() >= kKindBytes) {
+        return false;
+    }
+    for (const char c : kind) {
+        const bool ok = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string hex64(std::uint64_t value) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+    return text;
+}
+
+// Every file of a kind and params starts with this; the content hash follows.
+std::string filePrefix(const ArtifactKey& key) {
+    return key.kind + "-" + hex64(key.params) + "-";
+}
+
+std::string fileName(const Grid& grid, const ArtifactKey& key) {
+    return filePrefix(key) + hex64(grid.contentHash()) + ".bin";
+}
+
+} // namespace
+
+std::string ArtifactStore::directoryForMap(const std::string& mapPath) {
+    return mapPath.empty() ? std::string() : mapPath + ".cache";
+}
+
+ArtifactStore::ArtifactStore(std::string directory)
+    : directory_(std::move(directory)) {
+}
+
+ArtifactStore::~ArtifactStore() {
+    waitForBuilds();
+}
+
+void ArtifactStore::setDirectory(std::string directory) {
+    directory_ = std::move(directory);
+}
+
+const std::string& ArtifactStore::directory() const {
+    return directory_;
+}
+
+bool ArtifactStore::enabled() const {
+    return !directory_.empty();
+}
+
+std::string ArtifactStore::filePath(const Grid& grid, const ArtifactKey& key) const {
+    if (!enabled() || !validKind(key.kind)) {
+        return {};
+    }
+    return (std::filesystem::path(directory_) / fileName(grid, key)).string();
+}
+
+std::shared_ptr<const Artifact> ArtifactStore::load(const Grid& grid, const ArtifactKey& key, ArtifactError* err) const {
+    const std::string path = filePath(grid, key);
+    if (path.empty()) {
+        setError(err, "Artifact store is disabled or the kind is invalid.");
+        return nullptr;
+    }
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        setError(err, "No artifact for this map.");
+        return nullptr;
+    }
+
+    auto artifact = std::make_shared<Artifact>();
+    std::string ioErr;
+    if (!artifact->file_.open(path, &ioErr)) {
+        setError(err, ioErr);
+        return nullptr;
+    }
+    if (artifact->file_.size() < sizeof(ArtifactHeader)) {
+        setError(err, "File is too small to be an artifact.");
+        return nullptr;
+    }
+    ArtifactHeader header{};
+    std::memcpy(&header, artifact->file_.data(), sizeof(header));
+    char kind[kKindBytes] = {};
+    std::memcpy(kind, key.kind.data(), key.kind.size());
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion
+        || header.kindVersion != key.version || std::memcmp(header.kind, kind, kKindBytes) != 0) {
+        setError(err, "Invalid artifact header.");
+        return nullptr;
+    }
+    // The name already carries the hash; the header guards against renamed or copied files.
+    if (header.contentHash != grid.contentHash() || header.params != key.params
+        || static_cast<int>(header.width) != grid.width() || static_cast<int>(header.height) != grid.height()) {
+        setError(err, "Artifact was built for a different map or parameters.");
+        return nullptr;
+    }
+    if (artifact->file_.size() - sizeof(ArtifactHeader) < header.payloadBytes) {
+        setError(err, "Artifact is truncated.");
+        return nullptr;
+    }
+    artifact->payload_ = artifact->file_.data() + sizeof(ArtifactHeader);
+    artifact->size_ = static_cast<std::size_t>(header.payloadBytes);
+    return artifact;
+}
+
+bool ArtifactStore::store(const Grid& grid, const ArtifactKey& key, const std::vector<std::uint8_t>& payload,
+    ArtifactError* err) const {
+    if (!enabled()) {
+        return setError(err, "Artifact store is disabled.");
+    }
+    const std::uint64_t hash = grid.contentHash();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        currentHash_ = hash;
+    }
+    if (!storeIn(directory_, grid, key, payload, err)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    removeOthers(directory_, key, hash);
+    return true;
+}
+
+bool ArtifactStore::storeIn(const std::string& directory, const Grid& grid, const ArtifactKey& key,
+    const std::vector<std::uint8_t>& payload, ArtifactError* err) {
+    if (!validKind(key.kind)) {
+        return setError(err, "Invalid artifact kind.");
+    }
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        return setError(err, "Failed to create artifact directory.");
+    }
+
+    ArtifactHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.formatVersion = kFormatVersion;
+    header.kindVersion = key.version;
+    std::memcpy(header.kind, key.kind.data(), key.kind.size());
+    header.contentHash = grid.contentHash();
+    header.params = key.params;
+    header.width = static_cast<std::uint32_t>(grid.width());
+    header.height = static_cast<std::uint32_t>(grid.height());
+    header.payloadBytes = payload.size();
+
+    const std::string name = fileName(grid, key);
+    const fs::path target = fs::path(directory) / name;
+    static std::atomic<std::uint64_t> nextTemp{0};
+    const fs::path temp = fs::path(directory) / (name + ".tmp" + std::to_string(nextTemp++));
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return setError(err, "Failed to open file for writing.");
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        if (!out) {
+            out.close();
+            fs::remove(temp, ec);
+            return setError(err, "Failed while writing artifact.");
+        }
+    }
+    fs::rename(temp, target, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return setError(err, "Failed to move artifact into place.");
+    }
+
+    return true;
+}
+
+void ArtifactStore::removeOthers(const std::string& directory, const ArtifactKey& key, std::uint64_t contentHash) const {
+    // A newer file may already be there; it must survive a build that finished late.
+    if (contentHash != currentHash_) {
+        return;
+    }
+    namespace fs = std::filesystem;
+    const std::string prefix = filePrefix(key);
+    const std::string name = prefix + hex64(contentHash) + ".bin";
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, ec)) {
+        const std::string other = entry.path().filename().string();
+        if (other != name && other.size() > 4 && other.compare(0, prefix.size(), prefix) == 0
+            && other.compare(other.size() - 4, 4, ".bin") == 0) {
+            std::error_code removeErr;
+            fs::remove(entry.path(), removeErr);
+        }
+    }
+}
+
+bool ArtifactStore::rebuildAsync(const Grid& grid, const ArtifactKey& key, Builder build) {
+    const std::string path = filePath(grid, key);
+    if (path.empty() || !build) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    reapFinished();
+    if (!building_.insert(path).second) {
+        return false;
+    }
+    // filePath() brought the hash up to date, so the copy does not rehash on the worker. The
+    // copy is deep: the caller's grid decides copy-on-write from reference counts, which would
+    // not order its next in-place edit after the worker's reads.
+    currentHash_ = grid.contentHash();
+    workers_.emplace_back(path, std::thread([this, path, directory = directory_, copy = grid.deepCopy(), key, build]() {
+        std::vector<std::uint8_t> payload;
+        const bool built = build(copy, payload) && storeIn(directory, copy, key, payload, nullptr);
+        std::lock_guard<std::mutex> done(mutex_);
+        if (built) {
+            removeOthers(directory, key, copy.contentHash());
+        }
+        building_.erase(path);
+    }));
+    return true;
+}
+
+std::size_t ArtifactStore::pendingBuilds() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return building_.size();
+}
+
+void ArtifactStore::waitForBuilds() {
+    std::vector<std::pair<std::string, std::thread>> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        workers.swap(workers_);
+    }
+    for (auto& worker : workers) {
+        worker.second.join();
+    }
+}
+
+// Joins workers that have already left building_; called with mutex_ held.
+void ArtifactStore::reapFinished() {
+    for (auto it = workers_.begin(); it != workers_.end();) {
+        if (building_.count(it->first) == 0) {
+            it->second.join();
+            it = workers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace pathcore
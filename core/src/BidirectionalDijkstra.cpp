@@ -0,0 +1,299 @@
+#include "pathcore/BidirectionalDijkstra.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <queue>
+#include <vector>
+
+#include "pathcore/Grid.h"
+#include "pathcore/NodeState.h"
+#include "pathcore/SearchSnapshot.h"
+#include "pathcore/Types.h"
+
+namespace pathcore {
+
+namespace {
+
+struct QueueItem {
+    std::int32_t dist;
+    std::int32_t idx;
+};
+
+struct QueueItemCompare {
+    bool operator()(const QueueItem& a, const QueueItem& b) const {
+        return a.dist > b.dist;
+    }
+};
+
+using OpenList = std::priority_queue<QueueItem, std::pmr::vector<QueueItem>, QueueItemCompare>;
+
+constexpr std::uint8_t kClosedForward = 1;
+constexpr std::uint8_t kClosedBackward = 2;
+
+} // namespace
+
+SearchTask BidirectionalDijkstra::run() {
+    if (config_.penalizeTurns && config_.turnPenalty > 0) {
+        SearchTask forwardOnly = runForward();
+        while (forwardOnly.resume()) {
+            co_yield forwardOnly.expanded();
+        }
+        co_return;
+    }
+
+    const std::size_t total = hot_.size();
+    gBack_.assign(total, SearchSnapshot::kInfScore);
+    parentBack_.assign(total, SearchSnapshot::kNoParent);
+    closed_.assign(total, 0);
+
+    const std::int32_t startIdx = static_cast<std::int32_t>(grid().paddedIndex(start_));
+    const std::int32_t goalIdx = static_cast<std::int32_t>(grid().paddedIndex(goal_));
+    const std::int32_t* costs = grid().paddedCosts();
+    const bool eightWay = config_.neighborMode == NeighborMode::Eight;
+    const int* dirs = eightWay ? kEightDirs : kFourDirs;
+    const int dirCount = eightWay ? 8 : 4;
+
+    OpenList forward(QueueItemCompare{}, std::pmr::vector<QueueItem>(queryMemory()));
+    OpenList backward(QueueItemCompare{}, std::pmr::vector<QueueItem>(queryMemory()));
+    hot_[static_cast<std::size_t>(startIdx)].g = 0;
+    setState(startIdx, NodeState::Open);
+    forward.push(QueueItem{0, startIdx});
+    profilePush(startIdx);
+    gBack_[static_cast<std::size_t>(goalIdx)] = 0;
+    setState(goalIdx, NodeState::Open);
+    backward.push(QueueItem{0, goalIdx});
+    profilePush(goalIdx);
+
+    std::int64_t best = SearchSnapshot::kInfScore;
+    std::int32_t meet = SearchSnapshot::kNoParent;
+    if (startIdx == goalIdx) {
+        best = 0;
+        meet = startIdx;
+    }
+    co_yield 0;
+
+    // The squeezed cells of a diagonal are the same whichever end it is walked from.
+    auto blockedCorner = [&](std::int32_t idx, const int* deltas, int dir) {
+        return (dir & 1) != 0 && !config_.allowCornerCutting
+            && (costs[idx + deltas[kDiagAdjX[dir]]] == 0 || costs[idx + deltas[kDiagAdjY[dir]]] == 0);
+    };
+    auto offerMeeting = [&](std::int32_t idx) {
+        const std::size_t i = static_cast<std::size_t>(idx);
+        if (hot_[i].g == SearchSnapshot::kInfScore || gBack_[i] == SearchSnapshot::kInfScore) {
+            return;
+        }
+        const std::int64_t cost = static_cast<std::int64_t>(hot_[i].g) + gBack_[i];
+        if (cost < best) {
+            best = cost;
+            meet = idx;
+        }
+    };
+
+    while (true) {
+        // Assigning the grid may move the cost array, so look it up per resume like the other
+        // engines do per step().
+        costs = grid().paddedCosts();
+        while (!forward.empty()) {
+            const QueueItem& top = forward.top();
+            const std::size_t i = static_cast<std::size_t>(top.idx);
+            if ((closed_[i] & kClosedForward) == 0 && top.dist == hot_[i].g) {
+                break;
+            }
+            profileStalePop(top.idx);
+            forward.pop();
+        }
+        while (!backward.empty()) {
+            const QueueItem& top = backward.top();
+            const std::size_t i = static_cast<std::size_t>(top.idx);
+            if ((closed_[i] & kClosedBackward) == 0 && top.dist == gBack_[i]) {
+                break;
+            }
+            profileStalePop(top.idx);
+            backward.pop();
+        }
+        // An exhausted side has settled everything reachable from its end, so `best` is final.
+        if (forward.empty() || backward.empty()) {
+            break;
+        }
+        if (static_cast<std::int64_t>(forward.top().dist) + backward.top().dist >= best) {
+            break;
+        }
+
+        if (forward.top().dist <= backward.top().dist) {
+            const std::int32_t idx = forward.top().idx;
+            forward.pop();
+            const std::int32_t g = hot_[static_cast<std::size_t>(idx)].g;
+            closed_[static_cast<std::size_t>(idx)] |= kClosedForward;
+            setState(idx, NodeState::Closed);
+            profileExpansion(idx);
+
+            const int* deltas = grid().neighborDeltas(idx);
+            for (int k = 0; k < dirCount; ++k) {
+                const int dir = dirs[k];
+                const std::int32_t nIdx = idx + deltas[dir];
+                const std::int32_t cellCost = costs[nIdx];
+                if (cellCost == 0 || blockedCorner(idx, deltas, dir)) {
+                    continue;
+                }
+                const std::size_t n = static_cast<std::size_t>(nIdx);
+                if ((closed_[n] & kClosedForward) != 0) {
+                    continue;
+                }
+                const std::int32_t newG = g + (config_.useWeights ? cellCost : 1);
+                if (newG < hot_[n].g) {
+                    hot_[n].g = newG;
+                    hot_[n].dir = static_cast<std::uint8_t>(dir);
+                    if (closed_[n] == 0) {
+                        setState(nIdx, NodeState::Open);
+                    } else {
+                        touchCell(nIdx);
+                    }
+                    forward.push(QueueItem{newG, nIdx});
+                    profilePush(nIdx);
+                    offerMeeting(nIdx);
+                }
+            }
+        } else {
+            const std::int32_t idx = backward.top().idx;
+            backward.pop();
+            const std::size_t i = static_cast<std::size_t>(idx);
+            // Every move into idx costs the same, whichever neighbor it comes from.
+            const std::int32_t newG = gBack_[i] + (config_.useWeights ? costs[idx] : 1);
+            closed_[i] |= kClosedBackward;
+            setState(idx, NodeState::Closed);
+            profileExpansion(idx);
+
+            const int* deltas = grid().neighborDeltas(idx);
+            for (int k = 0; k < dirCount; ++k) {
+                const int dir = dirs[k];
+                const std::int32_t pIdx = idx + deltas[dir];
+                if (costs[pIdx] == 0 || blockedCorner(idx, deltas, dir)) {
+                    continue;
+                }
+                const std::size_t p = static_cast<std::size_t>(pIdx);
+                if ((closed_[p] & kClosedBackward) != 0) {
+                    continue;
+                }
+                if (newG < gBack_[p]) {
+                    gBack_[p] = newG;
+                    parentBack_[p] = idx;
+                    if (closed_[p] == 0) {
+                        setState(pIdx, NodeState::Open);
+                    }
+                    backward.push(QueueItem{newG, pIdx});
+                    profilePush(pIdx);
+                    offerMeeting(pIdx);
+                }
+            }
+        }
+        co_yield 1;
+    }
+
+    if (meet == SearchSnapshot::kNoParent) {
+        status_ = SearchStatus::NoPath;
+        co_return;
+    }
+    joinAt(meet);
+    status_ = SearchStatus::Found;
+}
+
+void BidirectionalDijkstra::joinAt(std::int32_t meet) {
+    const std::int32_t startIdx = static_cast<std::int32_t>(grid().paddedIndex(start_));
+    const std::int32_t goalIdx = static_cast<std::int32_t>(grid().paddedIndex(goal_));
+    const std::int32_t* costs = grid().paddedCosts();
+
+    std::int32_t cur = meet;
+    int steps = 0;
+    while (cur != goalIdx && steps < cellCount()) {
+        const std::int32_t next = parentBack_[static_cast<std::size_t>(cur)];
+        // Backward parents are neighbors; the forward side stores them as the arrival direction.
+        const int* deltas = grid().neighborDeltas(cur);
+        int dir = 0;
+        while (dir < 8 && cur + deltas[dir] != next) {
+            ++dir;
+        }
+        if (dir == 8) {
+            break;
+        }
+        HotNode& node = hot_[static_cast<std::size_t>(next)];
+        node.g = hot_[static_cast<std::size_t>(cur)].g + (config_.useWeights ? costs[next] : 1);
+        node.dir = static_cast<std::uint8_t>(dir);
+        setState(next, NodeState::Closed);
+        cur = next;
+        ++steps;
+    }
+    rebuildPath(startIdx, goalIdx);
+}
+
+SearchTask BidirectionalDijkstra::runForward() {
+    const std::int32_t startIdx = static_cast<std::int32_t>(grid().paddedIndex(start_));
+    const std::int32_t goalIdx = static_cast<std::int32_t>(grid().paddedIndex(goal_));
+    const std::int32_t* costs = grid().paddedCosts();
+    const bool eightWay = config_.neighborMode == NeighborMode::Eight;
+    const int* dirs = eightWay ? kEightDirs : kFourDirs;
+    const int dirCount = eightWay ? 8 : 4;
+
+    OpenList open(QueueItemCompare{}, std::pmr::vector<QueueItem>(queryMemory()));
+    hot_[static_cast<std::size_t>(startIdx)].g = 0;
+    setState(startIdx, NodeState::Open);
+    open.push(QueueItem{0, startIdx});
+    profilePush(startIdx);
+    co_yield 0;
+
+    while (!open.empty()) {
+        costs = grid().paddedCosts();
+        const QueueItem current = open.top();
+        open.pop();
+        HotNode& node = hot_[static_cast<std::size_t>(current.idx)];
+        if (node.state == NodeState::Closed || current.dist != node.g) {
+            profileStalePop(current.idx);
+            continue;
+        }
+
+        const std::int32_t idx = current.idx;
+        const std::int32_t g = node.g;
+        const std::uint8_t prevDir = node.dir;
+        setState(idx, NodeState::Closed);
+        profileExpansion(idx);
+        if (idx == goalIdx) {
+            rebuildPath(startIdx, goalIdx);
+            status_ = SearchStatus::Found;
+            co_return;
+        }
+
+        const int* deltas = grid().neighborDeltas(idx);
+        for (int k = 0; k < dirCount; ++k) {
+            const int dir = dirs[k];
+            const std::int32_t nIdx = idx + deltas[dir];
+            const std::int32_t cellCost = costs[nIdx];
+            if (cellCost == 0) {
+                continue;
+            }
+            if ((dir & 1) != 0 && !config_.allowCornerCutting) {
+                if (costs[idx + deltas[kDiagAdjX[dir]]] == 0 || costs[idx + deltas[kDiagAdjY[dir]]] == 0) {
+                    continue;
+                }
+            }
+            HotNode& next = hot_[static_cast<std::size_t>(nIdx)];
+            if (next.state == NodeState::Closed) {
+                continue;
+            }
+            std::int32_t newG = g + (config_.useWeights ? cellCost : 1);
+            if (prevDir != kNoDir && dir != prevDir) {
+                newG += config_.turnPenalty;
+            }
+            if (newG < next.g) {
+                next.g = newG;
+                next.dir = static_cast<std::uint8_t>(dir);
+                setState(nIdx, NodeState::Open);
+                open.push(QueueItem{newG, nIdx});
+                profilePush(nIdx);
+            }
+        }
+        co_yield 1;
+    }
+    status_ = SearchStatus::NoPath;
+}
+
+} // namespace pathcore
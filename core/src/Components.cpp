@@ -0,0 +1,523 @@
+#include "pathcore/Components.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
+namespace pathcore {
+namespace {
+
+constexpr std::size_t kParallelMinCells = 1u << 18;
+constexpr int kMinBandRows = 64;
+
+// Provisional union-find over cell indices; roots are always the smallest index of their set.
+struct CellForest {
+    std::vector<std::int32_t> link;
+
+    std::int32_t root(std::int32_t i) {
+        while (link[static_cast<std::size_t>(i)] != i) {
+            const std::size_t at = static_cast<std::size_t>(i);
+            link[at] = link[static_cast<std::size_t>(link[at])];
+            i = link[at];
+        }
+        return i;
+    }
+
+    void join(std::int32_t a, std::int32_t b) {
+        a = root(a);
+        b = root(b);
+        if (a == b) {
+            return;
+        }
+        if (a < b) {
+            std::swap(a, b);
+        }
+        link[static_cast<std::size_t>(a)] = b;
+    }
+};
+
+} // namespace
+
+void ComponentLabels::build(const Grid& grid, Connectivity connectivity, int threads) {
+    width_ = grid.width();
+    height_ = grid.height();
+    gridVersion_ = grid.version();
+    connectivity_ = connectivity;
+    needsRebuild_ = false;
+    valid_ = width_ > 0 && height_ > 0;
+    componentCount_ = 0;
+    cellLabel_.clear();
+    parent_.clear();
+    if (!valid_) {
+        return;
+    }
+
+    const std::size_t total = static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_);
+    const std::int32_t* costs = grid.paddedCosts();
+    std::vector<std::uint8_t> free(total, 0);
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            free[static_cast<std::size_t>(y * width_ + x)] = costs[grid.paddedIndex(CellPos{x, y})] != 0;
+        }
+    }
+
+    CellForest forest;
+    forest.link.assign(total, -1);
+    const bool eight = connectivity_ == Connectivity::Eight;
+
+    auto linkToRowAbove = [&](int x, std::int32_t i) {
+        const std::int32_t up = i - width_;
+        if (free[static_cast<std::size_t>(up)]) {
+            forest.join(i, up);
+        }
+        if (eight && x > 0 && free[static_cast<std::size_t>(up - 1)]) {
+            forest.join(i, up - 1);
+        }
+        if (eight && x + 1 < width_ && free[static_cast<std::size_t>(up + 1)]) {
+            forest.join(i, up + 1);
+        }
+    };
+
+    // Each band only touches its own rows, so bands can be labeled concurrently.
+    auto labelBand = [&](int rowBegin, int rowEnd) {
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            for (int x = 0; x < width_; ++x) {
+                const std::int32_t i = y * width_ + x;
+                if (!free[static_cast<std::size_t>(i)]) {
+                    continue;
+                }
+                forest.link[static_cast<std::size_t>(i)] = i;
+                if (x > 0 && free[static_cast<std::size_t>(i - 1)]) {
+                    forest.join(i, i - 1);
+                }
+                if (y > rowBegin) {
+                    linkToRowAbove(x, i);
+                }
+            }
+        }
+    };
+
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    int bands = 1;
+    if (total >= kParallelMinCells) {
+        bands = std::max(1, std::min(threads, height_ / kMinBandRows));
+    }
+
+    std::vector<int> bandStart;
+    for (int b = 0; b < bands; ++b) {
+        bandStart.push_back(static_cast<int>(static_cast<long long>(height_) * b / bands));
+    }
+    bandStart.push_back(height_);
+
+    if (bands == 1) {
+        labelBand(0, height_);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<std::size_t>(bands));
+        for (int b = 0; b < bands; ++b) {
+            workers.emplace_back(labelBand, bandStart[static_cast<std::size_t>(b)],
+                                 bandStart[static_cast<std::size_t>(b) + 1]);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (int b = 1; b < bands; ++b) {
+            const int y = bandStart[static_cast<std::size_t>(b)];
+            for (int x = 0; x < width_; ++x) {
+                const std::int32_t i = y * width_ + x;
+                if (free[static_cast<std::size_t>(i)]) {
+                    linkToRowAbove(x, i);
+                }
+            }
+        }
+    }
+
+    // Roots are the smallest index of each set, so a forward scan meets them first.
+    cellLabel_.assign(total, kBlocked);
+    for (std::size_t i = 0; i < total; ++i) {
+        if (!free[i]) {
+            continue;
+        }
+        const std::int32_t r = forest.root(static_cast<std::int32_t>(i));
+        if (static_cast<std::size_t>(r) == i) {
+            cellLabel_[i] = componentCount_++;
+        } else {
+            cellLabel_[i] = cellLabel_[static_cast<std::size_t>(r)];
+        }
+    }
+    parent_.resize(static_cast<std::size_t>(componentCount_));
+    for (std::int32_t id = 0; id < componentCount_; ++id) {
+        parent_[static_cast<std::size_t>(id)] = id;
+    }
+}
+
+void ComponentLabels::invalidate() {
+    valid_ = false;
+    needsRebuild_ = false;
+}
+
+bool ComponentLabels::valid() const {
+    return valid_;
+}
+
+bool ComponentLabels::matches(const Grid& grid, Connectivity connectivity) const {
+    return valid_ && gridVersion_ == grid.version() && width_ == grid.width() && height_ == grid.height()
+        && connectivity_ == connectivity;
+}
+
+Connectivity ComponentLabels::connectivity() const {
+    return connectivity_;
+}
+
+bool ComponentLabels::needsRebuild() const {
+    return needsRebuild_;
+}
+
+std::int32_t ComponentLabels::label(CellPos p) const {
+    if (!valid_ || !pathcore::inBounds(width_, height_, p)) {
+        return kBlocked;
+    }
+    const std::int32_t id = cellLabel_[static_cast<std::size_t>(p.y * width_ + p.x)];
+    if (id == kBlocked) {
+        return kBlocked;
+    }
+    return find(id);
+}
+
+bool ComponentLabels::isReachable(CellPos a, CellPos b) const {
+    const std::int32_t la = label(a);
+    return la != kBlocked && la == label(b);
+}
+
+int ComponentLabels::componentCount() const {
+    return componentCount_;
+}
+
+ArtifactKey ComponentLabels::artifactKey(Connectivity connectivity) {
+    ArtifactKey key;
+    key.kind = "components";
+    key.version = 1;
+    key.params = static_cast<std::uint64_t>(connectivity);
+    return key;
+}
+
+// Payload: component count and id count (int32), the cell labels, then every id's root.
+bool ComponentLabels::writeArtifact(std::vector<std::uint8_t>& payload) const {
+    if (!valid_ || needsRebuild_) {
+        return false;
+    }
+    const std::int32_t counts[2] = {componentCount_, static_cast<std::int32_t>(parent_.size())};
+    std::vector<std::int32_t> roots(parent_.size());
+    for (std::size_t id = 0; id < roots.size(); ++id) {
+        roots[id] = find(static_cast<std::int32_t>(id));
+    }
+    const std::size_t labelBytes = cellLabel_.size() * sizeof(std::int32_t);
+    payload.resize(sizeof(counts) + labelBytes + roots.size() * sizeof(std::int32_t));
+    std::memcpy(payload.data(), counts, sizeof(counts));
+    std::memcpy(payload.data() + sizeof(counts), cellLabel_.data(), labelBytes);
+    std::memcpy(payload.data() + sizeof(counts) + labelBytes, roots.data(), roots.size() * sizeof(std::int32_t));
+    return true;
+}
+
+bool ComponentLabels::loadArtifact(const Grid& grid, Connectivity connectivity, const Artifact& artifact) {
+    invalidate();
+    std::int32_t counts[2] = {};
+    if (artifact.size() < sizeof(counts)) {
+        return false;
+    }
+    std::memcpy(counts, artifact.data(), sizeof(counts));
+    const std::size_t total = static_cast<std::size_t>(grid.width()) * static_cast<std::size_t>(grid.height());
+    const std::size_t ids = static_cast<std::size_t>(std::max(counts[1], 0));
+    if (total == 0 || counts[0] < 0 || artifact.size() < sizeof(counts) + (total + ids) * sizeof(std::int32_t)) {
+        return false;
+    }
+    width_ = grid.width();
+    height_ = grid.height();
+    gridVersion_ = grid.version();
+    connectivity_ = connectivity;
+    componentCount_ = counts[0];
+    cellLabel_.resize(total);
+    parent_.resize(ids);
+    std::memcpy(cellLabel_.data(), artifact.data() + sizeof(counts), total * sizeof(std::int32_t));
+    std::memcpy(parent_.data(), artifact.data() + sizeof(counts) + total * sizeof(std::int32_t),
+        ids * sizeof(std::int32_t));
+    valid_ = true;
+    return true;
+}
+
+void ComponentLabels::onCellOpened(const Grid& grid, CellPos p) {
+    if (!valid_ || !pathcore::inBounds(width_, height_, p)) {
+        return;
+    }
+    gridVersion_ = grid.version();
+    const std::size_t i = static_cast<std::size_t>(p.y * width_ + p.x);
+    if (cellLabel_[i] != kBlocked || grid.isBlocked(p)) {
+        return;
+    }
+
+    cellLabel_[i] = newComponent();
+    ++componentCount_;
+    for (int dir = 0; dir < 8; ++dir) {
+        if (connectivity_ == Connectivity::Four && (dir & 1) != 0) {
+            continue;
+        }
+        const CellPos n{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+        if (!pathcore::inBounds(width_, height_, n)) {
+            continue;
+        }
+        const std::int32_t other = cellLabel_[static_cast<std::size_t>(n.y * width_ + n.x)];
+        if (other == kBlocked) {
+            continue;
+        }
+        if (find(other) != find(cellLabel_[i])) {
+            unite(other, cellLabel_[i]);
+            --componentCount_;
+        }
+    }
+
+    // Every opened cell adds an id; compact them once the union-find outgrows the grid.
+    if (parent_.size() > cellLabel_.size() * 2 + 1024) {
+        needsRebuild_ = true;
+    }
+}
+
+void ComponentLabels::onCellBlocked(const Grid& grid, CellPos p) {
+    if (!valid_ || !pathcore::inBounds(width_, height_, p)) {
+        return;
+    }
+    gridVersion_ = grid.version();
+    const std::size_t i = static_cast<std::size_t>(p.y * width_ + p.x);
+    if (cellLabel_[i] == kBlocked) {
+        return;
+    }
+    cellLabel_[i] = kBlocked;
+
+    bool hasFreeNeighbor = false;
+    for (int dir = 0; dir < 8; ++dir) {
+        if (connectivity_ == Connectivity::Four && (dir & 1) != 0) {
+            continue;
+        }
+        const CellPos n{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+        if (pathcore::inBounds(width_, height_, n)
+            && cellLabel_[static_cast<std::size_t>(n.y * width_ + n.x)] != kBlocked) {
+            hasFreeNeighbor = true;
+            break;
+        }
+    }
+    if (!hasFreeNeighbor) {
+        --componentCount_;
+        return;
+    }
+    CellPos reps[4];
+    const int groups = ringGroups(p, reps);
+    // Blocking can only split a component, so even if the split check gives up the labels
+    // never report two connected cells as unreachable; the next rebuild makes them exact.
+    if (groups > 1 && !splitAround(reps, groups)) {
+        needsRebuild_ = true;
+    }
+}
+
+void ComponentLabels::onCostChanged(const Grid& grid) {
+    if (valid_) {
+        gridVersion_ = grid.version();
+    }
+}
+
+std::int32_t ComponentLabels::find(std::int32_t id) const {
+    std::int32_t root = id;
+    while (parent_[static_cast<std::size_t>(root)] != root) {
+        root = parent_[static_cast<std::size_t>(root)];
+    }
+    while (parent_[static_cast<std::size_t>(id)] != root) {
+        const std::int32_t next = parent_[static_cast<std::size_t>(id)];
+        parent_[static_cast<std::size_t>(id)] = root;
+        id = next;
+    }
+    return root;
+}
+
+std::int32_t ComponentLabels::unite(std::int32_t a, std::int32_t b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+        return a;
+    }
+    if (a > b) {
+        std::swap(a, b);
+    }
+    parent_[static_cast<std::size_t>(b)] = a;
+    return a;
+}
+
+std::int32_t ComponentLabels::newComponent() {
+    const std::int32_t id = static_cast<std::int32_t>(parent_.size());
+    parent_.push_back(id);
+    return id;
+}
+
+// Groups the free neighbors of `p` by how they connect through the surrounding 3x3 ring and
+// returns one representative per group. A single group means blocking `p` split nothing.
+int ComponentLabels::ringGroups(CellPos p, CellPos* reps) const {
+    bool free[8] = {};
+    for (int dir = 0; dir < 8; ++dir) {
+        const CellPos n{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+        free[dir] = pathcore::inBounds(width_, height_, n)
+            && cellLabel_[static_cast<std::size_t>(n.y * width_ + n.x)] != kBlocked;
+    }
+
+    // Direction codes run around the ring, so consecutive codes are edge-adjacent; with
+    // Eight connectivity orthogonal cells two codes apart also touch diagonally.
+    int group[8];
+    for (int dir = 0; dir < 8; ++dir) {
+        group[dir] = dir;
+    }
+    auto groupOf = [&group](int d) {
+        while (group[d] != d) {
+            d = group[d];
+        }
+        return d;
+    };
+    auto merge = [&](int a, int b) {
+        if (free[a] && free[b]) {
+            group[groupOf(a)] = groupOf(b);
+        }
+    };
+    for (int dir = 0; dir < 8; ++dir) {
+        merge(dir, (dir + 1) % 8);
+        if (connectivity_ == Connectivity::Eight && (dir & 1) == 0) {
+            merge(dir, (dir + 2) % 8);
+        }
+    }
+
+    int count = 0;
+    bool seen[8] = {};
+    for (int dir = 0; dir < 8; ++dir) {
+        if (!free[dir] || (connectivity_ == Connectivity::Four && (dir & 1) != 0)) {
+            continue;
+        }
+        const int g = groupOf(dir);
+        if (!seen[g]) {
+            seen[g] = true;
+            reps[count++] = CellPos{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+        }
+    }
+    return count;
+}
+
+// Floods from every ring group in lockstep, one cell per group per round. Floods that meet
+// belong to the same region; a flood that runs dry while others are still going has been cut
+// off and gets a fresh id. Only the smaller sides of a split are ever walked completely.
+bool ComponentLabels::splitAround(const CellPos* reps, int count) {
+    const std::size_t cells = cellLabel_.size();
+    if (visitStamp_.size() != cells) {
+        visitStamp_.assign(cells, 0);
+        visitOwner_.assign(cells, 0);
+        stamp_ = 0;
+    }
+    if (++stamp_ == 0) {
+        std::fill(visitStamp_.begin(), visitStamp_.end(), 0u);
+        stamp_ = 1;
+    }
+
+    struct Flood {
+        std::vector<std::int32_t> cells;
+        std::size_t head{0};
+        int merged{0};
+        bool done{false};
+    };
+    std::vector<Flood> floods(static_cast<std::size_t>(count));
+    auto rootOf = [&floods](int f) {
+        while (floods[static_cast<std::size_t>(f)].merged != f) {
+            f = floods[static_cast<std::size_t>(f)].merged;
+        }
+        return f;
+    };
+    for (int f = 0; f < count; ++f) {
+        const std::int32_t i = reps[f].y * width_ + reps[f].x;
+        floods[static_cast<std::size_t>(f)].merged = f;
+        floods[static_cast<std::size_t>(f)].cells.push_back(i);
+        visitStamp_[static_cast<std::size_t>(i)] = stamp_;
+        visitOwner_[static_cast<std::size_t>(i)] = static_cast<std::uint8_t>(f);
+    }
+
+    // Past this many visited cells a relabel from scratch is no more expensive.
+    const std::size_t budget = std::max<std::size_t>(cells / 2, 4096);
+    std::size_t visited = static_cast<std::size_t>(count);
+    int live = count;
+
+    while (live > 1) {
+        for (int f = 0; f < count && live > 1; ++f) {
+            Flood& flood = floods[static_cast<std::size_t>(f)];
+            if (flood.done || flood.head == flood.cells.size()) {
+                continue;
+            }
+            const std::int32_t i = flood.cells[flood.head++];
+            const CellPos p{i % width_, i / width_};
+            for (int dir = 0; dir < 8; ++dir) {
+                if (connectivity_ == Connectivity::Four && (dir & 1) != 0) {
+                    continue;
+                }
+                const CellPos n{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+                if (!pathcore::inBounds(width_, height_, n)) {
+                    continue;
+                }
+                const std::size_t ni = static_cast<std::size_t>(n.y * width_ + n.x);
+                if (cellLabel_[ni] == kBlocked) {
+                    continue;
+                }
+                if (visitStamp_[ni] != stamp_) {
+                    visitStamp_[ni] = stamp_;
+                    visitOwner_[ni] = static_cast<std::uint8_t>(f);
+                    flood.cells.push_back(static_cast<std::int32_t>(ni));
+                    ++visited;
+                    continue;
+                }
+                const int a = rootOf(f);
+                const int b = rootOf(visitOwner_[ni]);
+                if (a != b) {
+                    floods[static_cast<std::size_t>(std::max(a, b))].merged = std::min(a, b);
+                    --live;
+                }
+            }
+            if (visited > budget) {
+                return false;
+            }
+        }
+
+        // A region is closed once none of its floods has anything left to expand.
+        for (int r = 0; r < count && live > 1; ++r) {
+            if (floods[static_cast<std::size_t>(r)].done || rootOf(r) != r) {
+                continue;
+            }
+            bool exhausted = true;
+            for (int f = 0; f < count && exhausted; ++f) {
+                const Flood& flood = floods[static_cast<std::size_t>(f)];
+                if (rootOf(f) == r && flood.head != flood.cells.size()) {
+                    exhausted = false;
+                }
+            }
+            if (!exhausted) {
+                continue;
+            }
+            const std::int32_t id = newComponent();
+            ++componentCount_;
+            for (int f = 0; f < count; ++f) {
+                Flood& flood = floods[static_cast<std::size_t>(f)];
+                if (rootOf(f) != r) {
+                    continue;
+                }
+                for (const std::int32_t cell : flood.cells) {
+                    cellLabel_[static_cast<std::size_t>(cell)] = id;
+                }
+                flood.done = true;
+            }
+            --live;
+        }
+    }
+    return true;
+}
+
+} // namespace pathcore
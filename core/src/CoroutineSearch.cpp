@@ -0,0 +1,84 @@
+#include "pathcore/CoroutineSearch.h"
+
+#include <new>
+
+namespace pathcore {
+
+namespace {
+
+// Each frame is preceded by the resource it came from (nullptr: the global heap), so
+// operator delete, which only gets the pointer and size, can give it back.
+constexpr std::size_t kFrameHeader = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+static_assert(kFrameHeader >= sizeof(std::pmr::memory_resource*));
+
+void* placeFrame(void* block, std::pmr::memory_resource* resource) {
+    *static_cast<std::pmr::memory_resource**>(block) = resource;
+    return static_cast<std::byte*>(block) + kFrameHeader;
+}
+
+} // namespace
+
+void* SearchTask::promise_type::operator new(std::size_t size, CoroutineSearch& engine) {
+    std::pmr::memory_resource* resource = engine.queryMemory();
+    return placeFrame(resource->allocate(size + kFrameHeader, kFrameHeader), resource);
+}
+
+void* SearchTask::promise_type::operator new(std::size_t size) {
+    return placeFrame(::operator new(size + kFrameHeader), nullptr);
+}
+
+void SearchTask::promise_type::operator delete(void* frame, std::size_t size) {
+    void* block = static_cast<std::byte*>(frame) - kFrameHeader;
+    std::pmr::memory_resource* resource = *static_cast<std::pmr::memory_resource**>(block);
+    if (resource != nullptr) {
+        resource->deallocate(block, size + kFrameHeader, kFrameHeader);
+    } else {
+        ::operator delete(block);
+    }
+}
+
+bool CoroutineSearch::reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) {
+    // The old frame may reference the previous grid; drop it before anything else.
+    task_ = SearchTask();
+    if (!commonReset(grid, start, goal, config)) {
+        return false;
+    }
+    if (status_ != SearchStatus::Running) {
+        return true;
+    }
+    task_ = run();
+    if (!task_.resume() && status_ == SearchStatus::Running) {
+        status_ = SearchStatus::NoPath;
+    }
+    return true;
+}
+
+SearchStatus CoroutineSearch::step(std::size_t iterations) {
+    if (status_ != SearchStatus::Running || cancelRequested()) {
+        return status_;
+    }
+
+    std::size_t expansions = 0;
+    std::size_t nextCheck = kCheckStride;
+    while (expansions < iterations && status_ == SearchStatus::Running) {
+        if (!task_.resume()) {
+            if (status_ == SearchStatus::Running) {
+                status_ = SearchStatus::NoPath;
+            }
+            break;
+        }
+        expansions += task_.expanded();
+        if (expansions >= nextCheck) {
+            nextCheck = expansions + kCheckStride;
+            if (cancelRequested()) {
+                break;
+            }
+        }
+    }
+    if (status_ != SearchStatus::Running) {
+        task_ = SearchTask();
+    }
+    return status_;
+}
+
+} // namespace pathcore
@@ -0,0 +1,66 @@
+#include "pathcore/CostFlood.h"
+
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "pathcore/SearchSnapshot.h"
+
+namespace pathcore {
+
+void floodCosts(const Grid& grid,
+    const SearchConfig& config,
+    const std::vector<std::int32_t>& seedSlots,
+    FloodDirection direction,
+    std::vector<std::int32_t>& dist) {
+    const std::int32_t* costs = grid.paddedCosts();
+    dist.assign(static_cast<std::size_t>(grid.paddedStorageSize()), SearchSnapshot::kInfScore);
+
+    using Item = std::pair<std::int32_t, std::int32_t>; // (dist, slot)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    for (const std::int32_t seed : seedSlots) {
+        if (seed < 0 || seed >= grid.paddedStorageSize() || costs[seed] == 0) {
+            continue;
+        }
+        dist[static_cast<std::size_t>(seed)] = 0;
+        open.push(Item{0, seed});
+    }
+
+    const bool eightWay = config.neighborMode == NeighborMode::Eight;
+    while (!open.empty()) {
+        const Item current = open.top();
+        open.pop();
+        const std::int32_t slot = current.second;
+        if (current.first != dist[static_cast<std::size_t>(slot)]) {
+            continue;
+        }
+
+        const int* deltas = grid.neighborDeltas(slot);
+        for (int dir = 0; dir < 8; ++dir) {
+            const bool diagonal = (dir & 1) != 0;
+            if (diagonal && !eightWay) {
+                continue;
+            }
+            const std::int32_t n = slot + deltas[dir];
+            if (costs[n] == 0) {
+                continue;
+            }
+            // A diagonal squeezes between the two orthogonal codes next to it; the check is the
+            // same in both directions, so it also holds for reversed moves.
+            if (diagonal && !config.allowCornerCutting
+                && (costs[slot + deltas[(dir + 7) & 7]] == 0 || costs[slot + deltas[(dir + 1) & 7]] == 0)) {
+                continue;
+            }
+
+            // Moves pay for the cell they enter: `n` going outwards, `slot` when walking back.
+            const std::int32_t entered = direction == FloodDirection::FromSeeds ? costs[n] : costs[slot];
+            const std::int32_t nd = current.first + (config.useWeights ? entered : 1);
+            if (nd < dist[static_cast<std::size_t>(n)]) {
+                dist[static_cast<std::size_t>(n)] = nd;
+                open.push(Item{nd, n});
+            }
+        }
+    }
+}
+
+} // namespace pathcore
@@ -12,33 +12,71 @@
 namespace pathcore {
 
 bool Dijkstra::reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) {
+    goalUnexpanded_ = false;
     if (!commonReset(grid, start, goal, config)) {
         return false;
     }
 
-    open_ = std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemCompare>();
+    open_.clear();
 
-    const int width = grid.width();
-    const std::int32_t startIdx = static_cast<std::int32_t>(toIndex(width, start));
-    const std::size_t startIndex = static_cast<std::size_t>(startIdx);
+    const std::int32_t startIdx = static_cast<std::int32_t>(grid.paddedIndex(start));
 
-    snapshot_.gScore[startIndex] = 0;
-    snapshot_.fScore[startIndex] = 0;
-    snapshot_.parent[startIndex] = SearchSnapshot::kNoParent;
-    snapshot_.state[startIndex] = NodeState::Open;
-    open_.push(QueueItem{0, startIdx});
+    hot_[static_cast<std::size_t>(startIdx)].g = 0;
+    setState(startIdx, NodeState::Open);
+    pushOpen(OpenEntry{0, 0, startIdx}, QueueItemCompare{});
 
     return true;
 }
 
+bool Dijkstra::retarget(CellPos goal) {
+    if (status_ == SearchStatus::NotStarted || grid_ == nullptr) {
+        return false;
+    }
+    const Grid& g = grid();
+    if (g.version() != gridVersion_ || !g.inBounds(goal) || g.isBlocked(goal)) {
+        return false;
+    }
+
+    clearPathMarks();
+    if (goalUnexpanded_) {
+        // The search stopped as soon as it closed the old goal, before relaxing its neighbors.
+        // Its distance is final and no smaller than anything left open, so it is expanded next.
+        const std::int32_t oldGoalIdx = static_cast<std::int32_t>(g.paddedIndex(goal_));
+        restoreState(oldGoalIdx, NodeState::Open);
+        const std::int32_t oldGoalG = hot_[static_cast<std::size_t>(oldGoalIdx)].g;
+        pushOpen(OpenEntry{oldGoalG, oldGoalG, oldGoalIdx}, QueueItemCompare{});
+        goalUnexpanded_ = false;
+    }
+    goal_ = goal;
+    if (components_ != nullptr && components_->matches(g, connectivityFor(config_))
+        && !components_->isReachable(start_, goal_)) {
+        status_ = SearchStatus::NoPath;
+        return true;
+    }
+
+    const std::int32_t startIdx = static_cast<std::int32_t>(g.paddedIndex(start_));
+    const std::int32_t goalIdx = static_cast<std::int32_t>(g.paddedIndex(goal_));
+    if (hot_[static_cast<std::size_t>(goalIdx)].state == NodeState::Closed) {
+        status_ = SearchStatus::Found;
+        rebuildPath(startIdx, goalIdx);
+        return true;
+    }
+    // An exhausted open list means every reachable cell is already closed.
+    status_ = open_.empty() ? SearchStatus::NoPath : SearchStatus::Running;
+    return true;
+}
+
 SearchStatus Dijkstra::step(std::size_t iterations) {
-    if (status_ != SearchStatus::Running) {
+    if (status_ != SearchStatus::Running || cancelRequested()) {
         return status_;
     }
 
-    const int width = grid().width();
-    const std::int32_t startIdx = static_cast<std::int32_t>(toIndex(width, start_));
-    const std::int32_t goalIdx = static_cast<std::int32_t>(toIndex(width, goal_));
+    const std::int32_t startIdx = static_cast<std::int32_t>(grid().paddedIndex(start_));
+    const std::int32_t goalIdx = static_cast<std::int32_t>(grid().paddedIndex(goal_));
+    const std::int32_t* costs = grid().paddedCosts();
+    const bool eightWay = config_.neighborMode == NeighborMode::Eight;
+    const int* dirs = eightWay ? kEightDirs : kFourDirs;
+    const int dirCount = eightWay ? 8 : 4;
 
     std::size_t expansions = 0;
     while (expansions < iterations) {
@@ -47,109 +85,75 @@ SearchStatus Dijkstra::step(std::size_t iterations) {
             return status_;
         }
 
-        QueueItem current = open_.top();
-        open_.pop();
+        const OpenEntry current = popOpen(QueueItemCompare{});
 
-        if (current.idx < 0 || current.idx >= snapshot_.size()) {
+        if (current.idx < 0 || current.idx >= cellCount()) {
             continue;
         }
 
-        const std::size_t idx = static_cast<std::size_t>(current.idx);
-        if (snapshot_.state[idx] == NodeState::Closed) {
+        const std::int32_t idx = current.idx;
+        const HotNode& node = hot_[static_cast<std::size_t>(idx)];
+        if (node.state == NodeState::Closed) {
+            profileStalePop(idx);
             continue;
         }
-        if (snapshot_.gScore[idx] == SearchSnapshot::kInfScore) {
+        if (node.g == SearchSnapshot::kInfScore) {
             continue;
         }
 
-        snapshot_.state[idx] = NodeState::Closed;
+        const std::int32_t g = node.g;
+        setState(idx, NodeState::Closed);
+        profileExpansion(idx);
         ++expansions;
 
         if (current.idx == goalIdx) {
             status_ = SearchStatus::Found;
+            goalUnexpanded_ = true;
             rebuildPath(startIdx, goalIdx);
             return status_;
         }
 
-        const CellPos pos = fromIndex(width, current.idx);
-        int prevDx = 0;
-        int prevDy = 0;
-        bool hasPrevDir = false;
-        const std::int32_t parentIdx = snapshot_.parent[idx];
-        if (parentIdx != SearchSnapshot::kNoParent && parentIdx >= 0 && parentIdx < snapshot_.size()) {
-            const CellPos parentPos = fromIndex(width, parentIdx);
-            prevDx = pos.x - parentPos.x;
-            prevDy = pos.y - parentPos.y;
-            hasPrevDir = true;
-        }
-        std::vector<CellPos> neighbors;
-        if (config_.neighborMode == NeighborMode::Four) {
-            neighbors = grid().neighbors4(pos);
-        } else {
-            neighbors = grid().neighbors8(pos);
-        }
-        for (const CellPos& neighbor : neighbors) {
-            if (config_.neighborMode == NeighborMode::Eight && !config_.allowCornerCutting) {
-                const int dx = neighbor.x - pos.x;
-                const int dy = neighbor.y - pos.y;
-                if (dx != 0 && dy != 0) {
-                    const CellPos adjX{pos.x + dx, pos.y};
-                    const CellPos adjY{pos.x, pos.y + dy};
-                    if (grid().isBlocked(adjX) || grid().isBlocked(adjY)) {
-                        continue;
-                    }
+        const std::uint8_t prevDir = node.dir;
+        const int* deltas = grid().neighborDeltas(idx);
+        for (int k = 0; k < dirCount; ++k) {
+            const int dir = dirs[k];
+            const std::int32_t nIdx = idx + deltas[dir];
+            const std::int32_t cellCost = costs[nIdx];
+            if (cellCost == 0) {
+                continue;
+            }
+            if ((dir & 1) != 0 && !config_.allowCornerCutting) {
+                if (costs[idx + deltas[kDiagAdjX[dir]]] == 0 || costs[idx + deltas[kDiagAdjY[dir]]] == 0) {
+                    continue;
                 }
             }
-            const std::int32_t nIdx = static_cast<std::int32_t>(toIndex(width, neighbor));
-            const std::size_t nIndex = static_cast<std::size_t>(nIdx);
 
-            if (snapshot_.state[nIndex] == NodeState::Closed) {
+            HotNode& next = hot_[static_cast<std::size_t>(nIdx)];
+            if (next.state == NodeState::Closed) {
                 continue;
             }
 
-            const std::int32_t stepCost =
-                config_.useWeights ? static_cast<std::int32_t>(grid().cost(neighbor)) : 1;
+            const std::int32_t stepCost = config_.useWeights ? cellCost : 1;
             std::int32_t turnPenalty = 0;
-            if (config_.penalizeTurns && hasPrevDir && config_.turnPenalty > 0) {
-                const int dx = neighbor.x - pos.x;
-                const int dy = neighbor.y - pos.y;
-                if (dx != prevDx || dy != prevDy) {
-                    turnPenalty = config_.turnPenalty;
-                }
+            if (config_.penalizeTurns && prevDir != kNoDir && config_.turnPenalty > 0 && dir != prevDir) {
+                turnPenalty = config_.turnPenalty;
             }
-            const std::int32_t newDist = snapshot_.gScore[idx] + stepCost + turnPenalty;
-
-            if (newDist < snapshot_.gScore[nIndex]) {
-                snapshot_.gScore[nIndex] = newDist;
-                snapshot_.fScore[nIndex] = newDist;
-                snapshot_.parent[nIndex] = current.idx;
-                snapshot_.state[nIndex] = NodeState::Open;
-                open_.push(QueueItem{newDist, nIdx});
+            const std::int32_t newDist = g + stepCost + turnPenalty;
+
+            if (newDist < next.g) {
+                next.g = newDist;
+                next.dir = static_cast<std::uint8_t>(dir);
+                setState(nIdx, NodeState::Open);
+                pushOpen(OpenEntry{newDist, newDist, nIdx}, QueueItemCompare{});
             }
         }
-    }
-
-    return status_;
-}
 
-void Dijkstra::rebuildPath(std::int32_t startIdx, std::int32_t goalIdx) {
-    std::int32_t cur = goalIdx;
-    int steps = 0;
-    const int limit = snapshot_.size();
-
-    while (cur != SearchSnapshot::kNoParent && cur != startIdx && steps < limit) {
-        snapshot_.state[static_cast<std::size_t>(cur)] = NodeState::Path;
-        cur = snapshot_.parent[static_cast<std::size_t>(cur)];
-        ++steps;
-    }
-
-    if (cur == startIdx) {
-        snapshot_.state[static_cast<std::size_t>(startIdx)] = NodeState::Path;
+        if (expansions % kCheckStride == 0 && cancelRequested()) {
+            return status_;
+        }
     }
 
-    if (goalIdx >= 0 && goalIdx < snapshot_.size()) {
-        snapshot_.state[static_cast<std::size_t>(goalIdx)] = NodeState::Path;
-    }
+    return status_;
 }
 
 } // namespace pathcore
@@ -0,0 +1,265 @@
+#include "pathcore/DistanceField.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "pathcore/CostFlood.h"
+#include "pathcore/SearchSnapshot.h"
+
+namespace pathcore {
+
+bool DistanceField::build(const Grid& grid, const SearchConfig& config, const std::vector<CellPos>& goals) {
+    clear();
+    if (grid.width() <= 0 || grid.height() <= 0) {
+        return false;
+    }
+
+    width_ = grid.width();
+    height_ = grid.height();
+    layout_ = grid.layout();
+    paddedIndex_ = grid.paddedIndexMap();
+    pad_ = grid.padding();
+    config_ = config;
+    std::vector<std::int32_t> seeds;
+    for (const CellPos& goal : goals) {
+        if (grid.inBounds(goal)) {
+            goals_.push_back(goal);
+            seeds.push_back(grid.paddedIndex(goal));
+        }
+    }
+
+    floodCosts(grid, config_, seeds, FloodDirection::ToSeeds, dist_);
+    flow_.assign(dist_.size(), kNoDir);
+    mark_.assign(dist_.size(), 0);
+    stamp_ = 0;
+    const std::int32_t* costs = grid.paddedCosts();
+    for (std::int32_t slot = 0; slot < static_cast<std::int32_t>(dist_.size()); ++slot) {
+        if (costs[slot] != 0 && dist_[static_cast<std::size_t>(slot)] != 0) {
+            settleFromNeighbors(grid, slot);
+        }
+    }
+    valid_ = true;
+    gridVersion_ = grid.version();
+    return true;
+}
+
+bool DistanceField::update(const Grid& grid, const std::vector<CellPos>& changed) {
+    if (!valid_ || grid.width() != width_ || grid.height() != height_ || grid.layout() != layout_) {
+        return false;
+    }
+    const std::int32_t* costs = grid.paddedCosts();
+    if (++stamp_ == 0) {
+        std::fill(mark_.begin(), mark_.end(), 0u);
+        stamp_ = 1;
+    }
+
+    // 1. Every cell whose flow runs through an edited cell (or squeezes diagonally past one)
+    //    loses its distance: walk the flow tree backwards from those cells.
+    std::vector<std::int32_t> invalid;
+    auto invalidate = [&](std::int32_t slot) {
+        if (mark_[static_cast<std::size_t>(slot)] != stamp_) {
+            mark_[static_cast<std::size_t>(slot)] = stamp_;
+            invalid.push_back(slot);
+        }
+    };
+    std::vector<std::int32_t> touched;
+    for (const CellPos& c : changed) {
+        if (!grid.inBounds(c)) {
+            continue;
+        }
+        const std::int32_t slot = grid.paddedIndex(c);
+        invalidate(slot);
+        const int* deltas = grid.neighborDeltas(slot);
+        for (int dir = 0; dir < 8; ++dir) {
+            const std::int32_t m = slot + deltas[dir];
+            touched.push_back(m);
+            const std::uint8_t f = flow_[static_cast<std::size_t>(m)];
+            if (f == kNoDir || (f & 1) == 0) {
+                continue;
+            }
+            const int* mDeltas = grid.neighborDeltas(m);
+            if (m + mDeltas[(f + 7) & 7] == slot || m + mDeltas[(f + 1) & 7] == slot) {
+                invalidate(m);
+            }
+        }
+    }
+    for (std::size_t i = 0; i < invalid.size(); ++i) {
+        const std::int32_t slot = invalid[i];
+        const int* deltas = grid.neighborDeltas(slot);
+        for (int dir = 0; dir < 8; ++dir) {
+            const std::int32_t m = slot + deltas[dir];
+            const std::uint8_t f = flow_[static_cast<std::size_t>(m)];
+            if (f != kNoDir && m + grid.neighborDeltas(m)[f] == slot) {
+                invalidate(m);
+            }
+        }
+    }
+    for (const std::int32_t slot : invalid) {
+        dist_[static_cast<std::size_t>(slot)] = SearchSnapshot::kInfScore;
+        flow_[static_cast<std::size_t>(slot)] = kNoDir;
+    }
+
+    // 2. Re-seed the invalidated cells from their intact neighbors; the edited cells' neighbors
+    //    go in with their current distance, since an edit can open new moves next to it.
+    using Item = std::pair<std::int32_t, std::int32_t>; // (dist, slot)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    for (const std::int32_t slot : invalid) {
+        if (costs[slot] == 0) {
+            continue;
+        }
+        const CellPos p = grid.fromPaddedIndex(slot);
+        if (std::find(goals_.begin(), goals_.end(), p) != goals_.end()) {
+            dist_[static_cast<std::size_t>(slot)] = 0;
+        } else {
+            settleFromNeighbors(grid, slot);
+        }
+        if (dist_[static_cast<std::size_t>(slot)] != SearchSnapshot::kInfScore) {
+            open.push(Item{dist_[static_cast<std::size_t>(slot)], slot});
+        }
+    }
+    for (const std::int32_t slot : touched) {
+        if (costs[slot] != 0 && dist_[static_cast<std::size_t>(slot)] != SearchSnapshot::kInfScore) {
+            open.push(Item{dist_[static_cast<std::size_t>(slot)], slot});
+        }
+    }
+
+    // 3. Dijkstra outwards from the seeds, lowering any neighbor that can now do better.
+    while (!open.empty()) {
+        const Item current = open.top();
+        open.pop();
+        const std::int32_t slot = current.second;
+        if (current.first != dist_[static_cast<std::size_t>(slot)]) {
+            continue;
+        }
+        const std::int32_t viaSlot = current.first + stepCost(grid, slot);
+        const int* deltas = grid.neighborDeltas(slot);
+        for (int dir = 0; dir < 8; ++dir) {
+            const std::int32_t m = slot + deltas[dir];
+            if (costs[m] == 0 || !legalMove(grid, slot, dir)) {
+                continue;
+            }
+            if (viaSlot < dist_[static_cast<std::size_t>(m)]) {
+                dist_[static_cast<std::size_t>(m)] = viaSlot;
+                flow_[static_cast<std::size_t>(m)] = static_cast<std::uint8_t>((dir + 4) & 7);
+                open.push(Item{viaSlot, m});
+            }
+        }
+    }
+    gridVersion_ = grid.version();
+    return true;
+}
+
+void DistanceField::clear() {
+    valid_ = false;
+    width_ = 0;
+    height_ = 0;
+    goals_.clear();
+    dist_.clear();
+    flow_.clear();
+    mark_.clear();
+}
+
+bool DistanceField::valid() const {
+    return valid_;
+}
+
+bool DistanceField::matches(const Grid& grid, const SearchConfig& config) const {
+    return valid_ && gridVersion_ == grid.version() && width_ == grid.width() && height_ == grid.height()
+        && layout_ == grid.layout() && config_.neighborMode == config.neighborMode && config_.useWeights == config.useWeights
+        && config_.allowCornerCutting == config.allowCornerCutting;
+}
+
+const std::vector<CellPos>& DistanceField::goals() const {
+    return goals_;
+}
+
+std::int32_t DistanceField::distance(CellPos p) const {
+    if (!valid_ || !pathcore::inBounds(width_, height_, p)) {
+        return SearchSnapshot::kInfScore;
+    }
+    return dist_[static_cast<std::size_t>(slotOf(p))];
+}
+
+int DistanceField::direction(CellPos p) const {
+    if (!valid_ || !pathcore::inBounds(width_, height_, p)) {
+        return -1;
+    }
+    const std::uint8_t f = flow_[static_cast<std::size_t>(slotOf(p))];
+    return f == kNoDir ? -1 : static_cast<int>(f);
+}
+
+std::int32_t DistanceField::maxDistance() const {
+    std::int32_t best = 0;
+    for (const std::int32_t d : dist_) {
+        if (d != SearchSnapshot::kInfScore && d > best) {
+            best = d;
+        }
+    }
+    return best;
+}
+
+std::vector<CellPos> DistanceField::pathFrom(CellPos p) const {
+    std::vector<CellPos> cells;
+    if (distance(p) == SearchSnapshot::kInfScore) {
+        return cells;
+    }
+    const int limit = width_ * height_;
+    cells.push_back(p);
+    for (int dir = direction(p); dir >= 0 && static_cast<int>(cells.size()) <= limit; dir = direction(p)) {
+        p = CellPos{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+        cells.push_back(p);
+    }
+    return cells;
+}
+
+bool DistanceField::legalMove(const Grid& grid, std::int32_t slot, int dir) const {
+    const std::int32_t* costs = grid.paddedCosts();
+    const int* deltas = grid.neighborDeltas(slot);
+    if (costs[slot + deltas[dir]] == 0) {
+        return false;
+    }
+    if ((dir & 1) == 0) {
+        return true;
+    }
+    if (config_.neighborMode != NeighborMode::Eight) {
+        return false;
+    }
+    // Symmetric, so it also answers for the reverse move.
+    return config_.allowCornerCutting
+        || (costs[slot + deltas[(dir + 7) & 7]] != 0 && costs[slot + deltas[(dir + 1) & 7]] != 0);
+}
+
+std::int32_t DistanceField::stepCost(const Grid& grid, std::int32_t slot) const {
+    return config_.useWeights ? grid.paddedCosts()[slot] : 1;
+}
+
+void DistanceField::settleFromNeighbors(const Grid& grid, std::int32_t slot) {
+    const int* deltas = grid.neighborDeltas(slot);
+    std::int32_t best = SearchSnapshot::kInfScore;
+    std::uint8_t bestDir = kNoDir;
+    for (int dir = 0; dir < 8; ++dir) {
+        if (!legalMove(grid, slot, dir)) {
+            continue;
+        }
+        const std::int32_t n = slot + deltas[dir];
+        const std::int32_t d = dist_[static_cast<std::size_t>(n)];
+        if (d == SearchSnapshot::kInfScore) {
+            continue;
+        }
+        const std::int32_t via = d + stepCost(grid, n);
+        if (via < best) {
+            best = via;
+            bestDir = static_cast<std::uint8_t>(dir);
+        }
+    }
+    dist_[static_cast<std::size_t>(slot)] = best;
+    flow_[static_cast<std::size_t>(slot)] = bestDir;
+}
+
+std::int32_t DistanceField::slotOf(CellPos p) const {
+    return paddedIndex_.toIndex(CellPos{p.x + pad_, p.y + pad_});
+}
+
+} // namespace pathcore
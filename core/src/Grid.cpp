@@ -1,11 +1,39 @@
 #include "pathcore/Grid.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 
 namespace pathcore {
 
-Grid::Grid(int width, int height, int defaultCost)
+namespace {
+
+constexpr int kHashTileShift = 3;
+constexpr int kHashTileSize = 1 << kHashTileShift;
+
+std::uint64_t nextVersion() {
+    static std::atomic<std::uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// splitmix64 finalizer.
+std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+std::uint64_t combine(std::uint64_t left, std::uint64_t right) {
+    return mix(left * 0x9e3779b97f4a7c15ull ^ right);
+}
+
+} // namespace
+
+Grid::Grid(int width, int height, int defaultCost, IndexLayout layout)
     : width_(width), height_(height) {
     if (width_ < 0 || height_ < 0) {
         assert(false && "Grid dimensions must be non-negative");
@@ -17,8 +45,78 @@ Grid::Grid(int width, int height, int defaultCost)
         defaultCost = 1;
     }
 
-    const std::size_t total = static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_);
-    cells_.assign(total, Cell{false, defaultCost});
+    index_ = IndexMap(width_, height_, layout);
+    CellChunk filled;
+    filled.fill(Cell{false, defaultCost});
+    const int chunkCount = (index_.storageSize() + kChunkMask) >> kChunkShift;
+    chunks_.reserve(static_cast<std::size_t>(chunkCount));
+    for (int i = 0; i < chunkCount; ++i) {
+        chunks_.push_back(std::make_shared<CellChunk>(filled));
+    }
+
+    pad_ = layout == IndexLayout::Tiled ? IndexMap::kTileSize : 1;
+    paddedIndex_ = IndexMap(width_ + 2 * pad_, height_ + 2 * pad_, layout);
+    padded_.assign(static_cast<std::size_t>(paddedIndex_.storageSize()), 0);
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            padded_[static_cast<std::size_t>(paddedIndex(CellPos{x, y}))] = defaultCost;
+        }
+    }
+
+    // Slot deltas only depend on the position inside a tile (or nothing for RowMajor), so
+    // measure them once around an interior slot.
+    const int classes = layout == IndexLayout::Tiled ? IndexMap::kTileSize * IndexMap::kTileSize : 1;
+    auto deltas = std::make_shared<std::vector<int>>(static_cast<std::size_t>(classes) * 8, 0);
+    for (int local = 0; local < classes; ++local) {
+        const CellPos base{pad_ + (local & IndexMap::kTileMask), pad_ + (local >> IndexMap::kTileShift)};
+        const int baseSlot = paddedIndex_.toIndex(base);
+        for (int dir = 0; dir < 8; ++dir) {
+            const CellPos n{base.x + kDirDx[dir], base.y + kDirDy[dir]};
+            (*deltas)[static_cast<std::size_t>(local * 8 + dir)] = paddedIndex_.toIndex(n) - baseSlot;
+        }
+    }
+    deltas_ = std::move(deltas);
+
+    version_ = nextVersion();
+    hashTilesX_ = (width_ + kHashTileSize - 1) >> kHashTileShift;
+    hashTileCount_ = hashTilesX_ * ((height_ + kHashTileSize - 1) >> kHashTileShift);
+    while (hashLeaves_ < hashTileCount_) {
+        hashLeaves_ *= 2;
+    }
+}
+
+Grid& Grid::operator=(const Grid& other) {
+    if (this == &other) {
+        return *this;
+    }
+    const bool sameShape = width_ == other.width_ && height_ == other.height_
+        && layout() == other.layout() && padded_.size() == other.padded_.size();
+    if (sameShape) {
+        // A chunk both grids hold has the same cells, so its padded slots already match.
+        for (std::size_t c = 0; c < chunks_.size(); ++c) {
+            if (chunks_[c] != other.chunks_[c]) {
+                chunks_[c] = other.chunks_[c];
+                copyPaddedChunk(other, c);
+            }
+        }
+    } else {
+        chunks_ = other.chunks_;
+        padded_ = other.padded_;
+    }
+    width_ = other.width_;
+    height_ = other.height_;
+    index_ = other.index_;
+    pad_ = other.pad_;
+    paddedIndex_ = other.paddedIndex_;
+    deltas_ = other.deltas_;
+    version_ = other.version_;
+    hashTilesX_ = other.hashTilesX_;
+    hashTileCount_ = other.hashTileCount_;
+    hashLeaves_ = other.hashLeaves_;
+    hashTree_ = other.hashTree_;
+    dirtyTiles_ = other.dirtyTiles_;
+    hashStale_ = other.hashStale_;
+    return *this;
 }
 
 int Grid::width() const {
@@ -33,25 +131,45 @@ int Grid::size() const {
     return width_ * height_;
 }
 
+const IndexMap& Grid::indexMap() const {
+    return index_;
+}
+
+IndexLayout Grid::layout() const {
+    return index_.layout();
+}
+
+int Grid::storageSize() const {
+    return index_.storageSize();
+}
+
+int Grid::toIndex(CellPos p) const {
+    return index_.toIndex(p);
+}
+
+CellPos Grid::fromIndex(int idx) const {
+    return index_.fromIndex(idx);
+}
+
 bool Grid::inBounds(CellPos p) const {
     return pathcore::inBounds(width_, height_, p);
 }
 
 const Cell& Grid::cell(CellPos p) const {
     assert(inBounds(p));
-    return cells_[static_cast<std::size_t>(toIndex(width_, p))];
-}
-
-Cell& Grid::cell(CellPos p) {
-    assert(inBounds(p));
-    return cells_[static_cast<std::size_t>(toIndex(width_, p))];
+    return cellAt(index_.toIndex(p));
 }
 
 bool Grid::setBlocked(CellPos p, bool blocked) {
     if (!inBounds(p)) {
         return false;
     }
-    cells_[static_cast<std::size_t>(toIndex(width_, p))].blocked = blocked;
+    const int idx = index_.toIndex(p);
+    if (cellAt(idx).blocked != blocked) {
+        mutableCellAt(idx).blocked = blocked;
+        updatePadded(p);
+        markEdited(p.x, p.y, p.x + 1, p.y + 1);
+    }
     return true;
 }
 
@@ -60,14 +178,19 @@ bool Grid::isBlocked(CellPos p) const {
         assert(false && "CellPos out of bounds");
         return true;
     }
-    return cells_[static_cast<std::size_t>(toIndex(width_, p))].blocked;
+    return cellAt(index_.toIndex(p)).blocked;
 }
 
 bool Grid::setCost(CellPos p, int cost) {
     if (!inBounds(p) || cost < 1) {
         return false;
     }
-    cells_[static_cast<std::size_t>(toIndex(width_, p))].cost = cost;
+    const int idx = index_.toIndex(p);
+    if (cellAt(idx).cost != cost) {
+        mutableCellAt(idx).cost = cost;
+        updatePadded(p);
+        markEdited(p.x, p.y, p.x + 1, p.y + 1);
+    }
     return true;
 }
 
@@ -76,13 +199,26 @@ int Grid::cost(CellPos p) const {
         assert(false && "CellPos out of bounds");
         return 1;
     }
-    return cells_[static_cast<std::size_t>(toIndex(width_, p))].cost;
+    return cellAt(index_.toIndex(p)).cost;
 }
 
 void Grid::clearBlocked() {
-    for (auto& cell : cells_) {
-        cell.blocked = false;
+    bool changed = false;
+    for (int i = 0; i < storageSize(); ++i) {
+        if (cellAt(i).blocked) {
+            mutableCellAt(i).blocked = false;
+            changed = true;
+        }
     }
+    if (!changed) {
+        return;
+    }
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            updatePadded(CellPos{x, y});
+        }
+    }
+    markEdited(0, 0, width_, height_);
 }
 
 void Grid::fillCost(int cost) {
@@ -90,9 +226,65 @@ void Grid::fillCost(int cost) {
         assert(false && "Cost must be >= 1");
         return;
     }
-    for (auto& cell : cells_) {
-        cell.cost = cost;
+    bool changed = false;
+    for (int i = 0; i < storageSize(); ++i) {
+        if (cellAt(i).cost != cost) {
+            mutableCellAt(i).cost = cost;
+            changed = true;
+        }
+    }
+    if (!changed) {
+        return;
+    }
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            updatePadded(CellPos{x, y});
+        }
+    }
+    markEdited(0, 0, width_, height_);
+}
+
+bool Grid::fillRect(CellPos origin, int width, int height, const Cell& value) {
+    if (value.cost < 1) {
+        return false;
+    }
+    const int x0 = std::max(origin.x, 0);
+    const int y0 = std::max(origin.y, 0);
+    const int x1 = std::min(origin.x + width, width_);
+    const int y1 = std::min(origin.y + height, height_);
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+    for (int y = y0; y < y1; ++y) {
+        writeRow(x0, y, x1 - x0, &value, 0);
+    }
+    markEdited(x0, y0, x1, y1);
+    return true;
+}
+
+bool Grid::stamp(CellPos origin, int patternWidth, const std::vector<Cell>& pattern) {
+    if (patternWidth <= 0 || pattern.empty() || pattern.size() % static_cast<std::size_t>(patternWidth) != 0) {
+        return false;
+    }
+    for (const Cell& c : pattern) {
+        if (c.cost < 1) {
+            return false;
+        }
+    }
+    const int patternHeight = static_cast<int>(pattern.size() / static_cast<std::size_t>(patternWidth));
+    const int x0 = std::max(origin.x, 0);
+    const int y0 = std::max(origin.y, 0);
+    const int x1 = std::min(origin.x + patternWidth, width_);
+    const int y1 = std::min(origin.y + patternHeight, height_);
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+    for (int y = y0; y < y1; ++y) {
+        const std::size_t row = static_cast<std::size_t>(y - origin.y) * static_cast<std::size_t>(patternWidth);
+        writeRow(x0, y, x1 - x0, &pattern[row + static_cast<std::size_t>(x0 - origin.x)], 1);
     }
+    markEdited(x0, y0, x1, y1);
+    return true;
 }
 
 std::vector<CellPos> Grid::neighbors4(CellPos p) const {
@@ -149,4 +341,193 @@ std::vector<CellPos> Grid::neighbors8(CellPos p) const {
     return result;
 }
 
+const std::int32_t* Grid::paddedCosts() const {
+    return padded_.data();
+}
+
+int Grid::paddedStorageSize() const {
+    return static_cast<int>(padded_.size());
+}
+
+int Grid::paddedIndex(CellPos p) const {
+    return paddedIndex_.toIndex(CellPos{p.x + pad_, p.y + pad_});
+}
+
+CellPos Grid::fromPaddedIndex(int slot) const {
+    const CellPos p = paddedIndex_.fromIndex(slot);
+    return CellPos{p.x - pad_, p.y - pad_};
+}
+
+const IndexMap& Grid::paddedIndexMap() const {
+    return paddedIndex_;
+}
+
+int Grid::padding() const {
+    return pad_;
+}
+
+const int* Grid::neighborDeltas(int slot) const {
+    if (index_.layout() == IndexLayout::Tiled) {
+        return &(*deltas_)[static_cast<std::size_t>(slot & (IndexMap::kTileSize * IndexMap::kTileSize - 1)) * 8];
+    }
+    return deltas_->data();
+}
+
+int Grid::sharedChunks() const {
+    int shared = 0;
+    for (const auto& chunk : chunks_) {
+        if (chunk.use_count() > 1) {
+            ++shared;
+        }
+    }
+    return shared;
+}
+
+Grid Grid::deepCopy() const {
+    Grid copy(*this);
+    for (auto& chunk : copy.chunks_) {
+        chunk = std::make_shared<CellChunk>(*chunk);
+    }
+    if (hashTree_ != nullptr) {
+        copy.hashTree_ = std::make_shared<std::vector<std::uint64_t>>(*hashTree_);
+    }
+    return copy;
+}
+
+Cell& Grid::mutableCellAt(int idx) {
+    std::shared_ptr<CellChunk>& chunk = chunks_[static_cast<std::size_t>(idx >> kChunkShift)];
+    if (chunk.use_count() > 1) {
+        chunk = std::make_shared<CellChunk>(*chunk);
+    }
+    return (*chunk)[static_cast<std::size_t>(idx & kChunkMask)];
+}
+
+std::uint64_t Grid::version() const {
+    return version_;
+}
+
+std::uint64_t Grid::contentHash() const {
+    const std::size_t leaves = static_cast<std::size_t>(hashLeaves_);
+    const std::uint64_t shape = (static_cast<std::uint64_t>(width_) << 32) | static_cast<std::uint32_t>(height_);
+    if (!hashStale_ && dirtyTiles_.empty()) {
+        return combine((*hashTree_)[1], shape);
+    }
+    if (hashTree_ == nullptr || hashTree_.use_count() > 1) {
+        // Shared with a copy (or never built): rehash into a tree of our own.
+        auto tree = hashTree_ != nullptr ? std::make_shared<std::vector<std::uint64_t>>(*hashTree_)
+                                         : std::make_shared<std::vector<std::uint64_t>>(2 * leaves, 0);
+        hashTree_ = std::move(tree);
+    }
+    std::vector<std::uint64_t>& tree = *hashTree_;
+    if (hashStale_) {
+        for (int t = 0; t < hashTileCount_; ++t) {
+            tree[leaves + static_cast<std::size_t>(t)] = hashTile(t);
+        }
+        for (std::size_t i = leaves - 1; i >= 1; --i) {
+            tree[i] = combine(tree[2 * i], tree[2 * i + 1]);
+        }
+    } else {
+        for (const std::int32_t t : dirtyTiles_) {
+            std::size_t i = leaves + static_cast<std::size_t>(t);
+            tree[i] = hashTile(t);
+            for (i /= 2; i >= 1; i /= 2) {
+                tree[i] = combine(tree[2 * i], tree[2 * i + 1]);
+            }
+        }
+    }
+    hashStale_ = false;
+    dirtyTiles_.clear();
+    return combine(tree[1], shape);
+}
+
+void Grid::markEdited(int x0, int y0, int x1, int y1) {
+    version_ = nextVersion();
+    if (hashStale_) {
+        return;
+    }
+    const int tx0 = x0 >> kHashTileShift;
+    const int tx1 = (x1 - 1) >> kHashTileShift;
+    const int ty0 = y0 >> kHashTileShift;
+    const int ty1 = (y1 - 1) >> kHashTileShift;
+    // Past a quarter of the tiles one full pass is cheaper than the walks up the tree.
+    const std::size_t limit = static_cast<std::size_t>(hashTileCount_ / 4 + 1);
+    if (dirtyTiles_.size() + static_cast<std::size_t>((tx1 - tx0 + 1) * (ty1 - ty0 + 1)) > limit) {
+        hashStale_ = true;
+        dirtyTiles_.clear();
+        return;
+    }
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const std::int32_t t = ty * hashTilesX_ + tx;
+            // Strokes edit the same tile many times in a row.
+            if (dirtyTiles_.empty() || dirtyTiles_.back() != t) {
+                dirtyTiles_.push_back(t);
+            }
+        }
+    }
+}
+
+std::uint64_t Grid::hashTile(int tile) const {
+    const int x0 = (tile % hashTilesX_) << kHashTileShift;
+    const int y0 = (tile / hashTilesX_) << kHashTileShift;
+    const int x1 = std::min(x0 + kHashTileSize, width_);
+    const int y1 = std::min(y0 + kHashTileSize, height_);
+    std::uint64_t h = mix(static_cast<std::uint64_t>(tile) + 1);
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            const Cell& c = cellAt(index_.toIndex(CellPos{x, y}));
+            const std::uint32_t value = c.blocked ? 0u : static_cast<std::uint32_t>(c.cost);
+            h = (h ^ value) * 0x100000001b3ull;
+        }
+    }
+    return mix(h);
+}
+
+void Grid::copyPaddedChunk(const Grid& other, std::size_t chunk) {
+    const int first = static_cast<int>(chunk) << kChunkShift;
+    const int last = std::min(first + kChunkSlots, storageSize());
+    for (int idx = first; idx < last; ++idx) {
+        const CellPos p = index_.fromIndex(idx);
+        // Tiled storage rounds up to whole tiles; those slots hold no cell.
+        if (inBounds(p)) {
+            const std::size_t slot = static_cast<std::size_t>(paddedIndex(p));
+            padded_[slot] = other.padded_[slot];
+        }
+    }
+}
+
+void Grid::writeRow(int x, int y, int count, const Cell* values, int step) {
+    // RowMajor rows are contiguous in both arrays; Tiled ones only within a tile, and the
+    // padding is a whole tile, so runs break at the same x in the chunks and padded_. Runs
+    // also stop at chunk ends.
+    const bool tiled = index_.layout() == IndexLayout::Tiled;
+    std::int32_t* paddedBase = padded_.data();
+    while (count > 0) {
+        const int idx = index_.toIndex(CellPos{x, y});
+        int run = tiled ? std::min(count, IndexMap::kTileSize - (x & IndexMap::kTileMask)) : count;
+        run = std::min(run, kChunkSlots - (idx & kChunkMask));
+        Cell* cells = &mutableCellAt(idx);
+        std::int32_t* padded = paddedBase + paddedIndex(CellPos{x, y});
+        if (step == 0) {
+            std::fill_n(cells, run, *values);
+            std::fill_n(padded, run, values->blocked ? 0 : values->cost);
+        } else {
+            std::copy_n(values, run, cells);
+            for (int i = 0; i < run; ++i) {
+                padded[i] = values[i].blocked ? 0 : values[i].cost;
+            }
+            values += run;
+        }
+        x += run;
+        count -= run;
+    }
+}
+
+void Grid::updatePadded(CellPos p) {
+    const Cell& c = cellAt(index_.toIndex(p));
+    const std::int32_t value = c.blocked ? 0 : c.cost;
+    const std::size_t slot = static_cast<std::size_t>(paddedIndex(p));
+    padded_[slot] = value;
+}
+
 } // namespace pathcore
@@ -0,0 +1,313 @@
+#include "pathcore/LandmarkHeuristic.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <thread>
+
+#include "pathcore/CostFlood.h"
+#include "pathcore/SearchSnapshot.h"
+
+namespace pathcore {
+namespace {
+
+// Lowers `hops` to the step count from `source` wherever that is shorter (4-neighbor BFS).
+void lowerHops(const Grid& grid, std::int32_t source, std::vector<std::int32_t>& hops) {
+    const std::int32_t* costs = grid.paddedCosts();
+    std::deque<std::int32_t> queue;
+    hops[static_cast<std::size_t>(source)] = 0;
+    queue.push_back(source);
+    while (!queue.empty()) {
+        const std::int32_t slot = queue.front();
+        queue.pop_front();
+        const std::int32_t next = hops[static_cast<std::size_t>(slot)] + 1;
+        const int* deltas = grid.neighborDeltas(slot);
+        for (int dir = 0; dir < 8; dir += 2) {
+            const std::int32_t n = slot + deltas[dir];
+            if (costs[n] != 0 && next < hops[static_cast<std::size_t>(n)]) {
+                hops[static_cast<std::size_t>(n)] = next;
+                queue.push_back(n);
+            }
+        }
+    }
+}
+
+std::int32_t farthestSlot(const std::vector<std::int32_t>& hops) {
+    std::int32_t best = -1;
+    std::int32_t bestHops = 0;
+    for (std::size_t slot = 0; slot < hops.size(); ++slot) {
+        const std::int32_t h = hops[slot];
+        if (h != SearchSnapshot::kInfScore && h > bestHops) {
+            bestHops = h;
+            best = static_cast<std::int32_t>(slot);
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+bool LandmarkHeuristic::build(const Grid& grid, const SearchConfig& config, int landmarkCount, int threads) {
+    clear();
+    if (grid.width() <= 0 || grid.height() <= 0 || landmarkCount <= 0) {
+        return false;
+    }
+
+    selectLandmarks(grid, landmarkCount);
+    if (landmarkSlots_.empty()) {
+        return false;
+    }
+
+    width_ = grid.width();
+    height_ = grid.height();
+    layout_ = grid.layout();
+    gridVersion_ = grid.version();
+    neighborMode_ = config.neighborMode;
+    useWeights_ = config.useWeights;
+    allowCornerCutting_ = config.allowCornerCutting;
+    slots_ = static_cast<std::size_t>(grid.paddedStorageSize());
+
+    const std::size_t count = landmarkSlots_.size();
+    fromLandmark_.assign(count * slots_, kUnknown);
+    toLandmark_.assign(count * slots_, kUnknown);
+
+    // One job per landmark and direction; each writes its own slice of a table.
+    const int jobs = static_cast<int>(count * 2);
+    std::atomic<int> nextJob{0};
+    auto worker = [&]() {
+        std::vector<std::int32_t> dist;
+        for (int job = nextJob++; job < jobs; job = nextJob++) {
+            const std::size_t k = static_cast<std::size_t>(job / 2);
+            const bool outwards = (job & 1) == 0;
+            floodCosts(grid, config, {landmarkSlots_[k]},
+                outwards ? FloodDirection::FromSeeds : FloodDirection::ToSeeds, dist);
+            std::uint16_t* out = (outwards ? fromLandmark_.data() : toLandmark_.data()) + k * slots_;
+            for (std::size_t slot = 0; slot < slots_; ++slot) {
+                const std::int32_t d = dist[slot];
+                out[slot] = d < kUnknown ? static_cast<std::uint16_t>(d) : kUnknown;
+            }
+        }
+    };
+
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threads = std::max(1, std::min(threads, jobs));
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<std::size_t>(threads - 1));
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    fromTable_ = fromLandmark_.data();
+    toTable_ = toLandmark_.data();
+    goalFrom_.assign(count, -1);
+    goalTo_.assign(count, -1);
+    valid_ = true;
+    return true;
+}
+
+void LandmarkHeuristic::clear() {
+    valid_ = false;
+    slots_ = 0;
+    landmarks_.clear();
+    landmarkSlots_.clear();
+    fromTable_ = nullptr;
+    toTable_ = nullptr;
+    fromLandmark_.clear();
+    toLandmark_.clear();
+    artifact_.reset();
+    goalFrom_.clear();
+    goalTo_.clear();
+}
+
+bool LandmarkHeuristic::valid() const {
+    return valid_;
+}
+
+bool LandmarkHeuristic::matches(const Grid& grid, const SearchConfig& config) const {
+    return valid_ && width_ == grid.width() && height_ == grid.height() && layout_ == grid.layout()
+        && neighborMode_ == config.neighborMode && useWeights_ == config.useWeights
+        && allowCornerCutting_ == config.allowCornerCutting;
+}
+
+bool LandmarkHeuristic::current(const Grid& grid, const SearchConfig& config) const {
+    return matches(grid, config) && gridVersion_ == grid.version();
+}
+
+const std::vector<CellPos>& LandmarkHeuristic::landmarks() const {
+    return landmarks_;
+}
+
+// Slots depend on the layout, so it is part of the key even though the content hash is not.
+ArtifactKey LandmarkHeuristic::artifactKey(const Grid& grid, const SearchConfig& config, int landmarkCount) {
+    ArtifactKey key;
+    key.kind = "landmarks";
+    key.version = 1;
+    key.params = static_cast<std::uint64_t>(config.neighborMode) | (config.useWeights ? 1ull << 1 : 0)
+        | (config.allowCornerCutting ? 1ull << 2 : 0) | (static_cast<std::uint64_t>(grid.layout()) << 4)
+        | (static_cast<std::uint64_t>(static_cast<std::uint32_t>(landmarkCount)) << 8);
+    return key;
+}
+
+// Payload: landmark count (uint32), padding, slot count (uint64), the landmark cells as int32
+// pairs, then both tables.
+bool LandmarkHeuristic::writeArtifact(std::vector<std::uint8_t>& payload) const {
+    if (!valid_) {
+        return false;
+    }
+    const std::uint32_t count = static_cast<std::uint32_t>(landmarks_.size());
+    const std::uint64_t slots = slots_;
+    const std::size_t tableBytes = count * slots_ * sizeof(std::uint16_t);
+    payload.assign(16 + count * 8 + 2 * tableBytes, 0);
+    std::uint8_t* out = payload.data();
+    std::memcpy(out, &count, sizeof(count));
+    std::memcpy(out + 8, &slots, sizeof(slots));
+    out += 16;
+    for (const CellPos& p : landmarks_) {
+        const std::int32_t xy[2] = {p.x, p.y};
+        std::memcpy(out, xy, sizeof(xy));
+        out += sizeof(xy);
+    }
+    std::memcpy(out, fromTable_, tableBytes);
+    std::memcpy(out + tableBytes, toTable_, tableBytes);
+    return true;
+}
+
+bool LandmarkHeuristic::loadArtifact(const Grid& grid, const SearchConfig& config,
+    std::shared_ptr<const Artifact> artifact) {
+    clear();
+    if (!artifact || artifact->size() < 16) {
+        return false;
+    }
+    const std::uint8_t* in = artifact->data();
+    std::uint32_t count = 0;
+    std::uint64_t slots = 0;
+    std::memcpy(&count, in, sizeof(count));
+    std::memcpy(&slots, in + 8, sizeof(slots));
+    const std::size_t tableBytes = count * static_cast<std::size_t>(slots) * sizeof(std::uint16_t);
+    if (count == 0 || slots != static_cast<std::uint64_t>(grid.paddedStorageSize())
+        || artifact->size() < 16 + count * 8 + 2 * tableBytes) {
+        return false;
+    }
+    in += 16;
+    for (std::uint32_t k = 0; k < count; ++k) {
+        std::int32_t xy[2];
+        std::memcpy(xy, in, sizeof(xy));
+        in += sizeof(xy);
+        const CellPos p{xy[0], xy[1]};
+        if (!grid.inBounds(p)) {
+            clear();
+            return false;
+        }
+        landmarks_.push_back(p);
+        landmarkSlots_.push_back(static_cast<std::int32_t>(grid.paddedIndex(p)));
+    }
+
+    width_ = grid.width();
+    height_ = grid.height();
+    layout_ = grid.layout();
+    gridVersion_ = grid.version();
+    neighborMode_ = config.neighborMode;
+    useWeights_ = config.useWeights;
+    allowCornerCutting_ = config.allowCornerCutting;
+    slots_ = static_cast<std::size_t>(slots);
+    fromTable_ = reinterpret_cast<const std::uint16_t*>(in);
+    toTable_ = reinterpret_cast<const std::uint16_t*>(in + tableBytes);
+    artifact_ = std::move(artifact);
+    goalFrom_.assign(count, -1);
+    goalTo_.assign(count, -1);
+    valid_ = true;
+    return true;
+}
+
+bool LandmarkHeuristic::loadFrom(ArtifactStore& store, const Grid& grid, const SearchConfig& config, int landmarkCount) {
+    const ArtifactKey key = artifactKey(grid, config, landmarkCount);
+    if (loadArtifact(grid, config, store.load(grid, key))) {
+        return true;
+    }
+    store.rebuildAsync(grid, key, [config, landmarkCount](const Grid& copy, std::vector<std::uint8_t>& payload) {
+        LandmarkHeuristic built;
+        return built.build(copy, config, landmarkCount) && built.writeArtifact(payload);
+    });
+    return false;
+}
+
+bool LandmarkHeuristic::prepare(const Grid& grid, CellPos goal, const SearchConfig& config) {
+    if (!current(grid, config) || !grid.inBounds(goal)) {
+        return false;
+    }
+    const std::size_t goalSlot = static_cast<std::size_t>(grid.paddedIndex(goal));
+    for (std::size_t k = 0; k < landmarkSlots_.size(); ++k) {
+        const std::uint16_t from = fromTable_[k * slots_ + goalSlot];
+        const std::uint16_t to = toTable_[k * slots_ + goalSlot];
+        goalFrom_[k] = from == kUnknown ? -1 : from;
+        goalTo_[k] = to == kUnknown ? -1 : to;
+    }
+    return true;
+}
+
+std::int32_t LandmarkHeuristic::estimate(CellPos p, std::int32_t slot) const {
+    (void)p;
+    std::int32_t best = 0;
+    const std::size_t at = static_cast<std::size_t>(slot);
+    for (std::size_t k = 0; k < landmarkSlots_.size(); ++k) {
+        // cost(p, goal) >= cost(L, goal) - cost(L, p) and >= cost(p, L) - cost(goal, L).
+        const std::uint16_t from = fromTable_[k * slots_ + at];
+        if (goalFrom_[k] >= 0 && from != kUnknown) {
+            best = std::max(best, goalFrom_[k] - static_cast<std::int32_t>(from));
+        }
+        const std::uint16_t to = toTable_[k * slots_ + at];
+        if (goalTo_[k] >= 0 && to != kUnknown) {
+            best = std::max(best, static_cast<std::int32_t>(to) - goalTo_[k]);
+        }
+    }
+    return best;
+}
+
+// Farthest-point selection on step counts: start from the free cell nearest the centre, take
+// the cell farthest from it, then repeatedly the cell farthest from every landmark so far.
+void LandmarkHeuristic::selectLandmarks(const Grid& grid, int count) {
+    std::int32_t seed = -1;
+    long long seedDist = 0;
+    const int cx = grid.width() / 2;
+    const int cy = grid.height() / 2;
+    for (int y = 0; y < grid.height(); ++y) {
+        for (int x = 0; x < grid.width(); ++x) {
+            const CellPos p{x, y};
+            if (grid.isBlocked(p)) {
+                continue;
+            }
+            const long long d = static_cast<long long>(x - cx) * (x - cx) + static_cast<long long>(y - cy) * (y - cy);
+            if (seed < 0 || d < seedDist) {
+                seed = static_cast<std::int32_t>(grid.paddedIndex(p));
+                seedDist = d;
+            }
+        }
+    }
+    if (seed < 0) {
+        return;
+    }
+
+    std::vector<std::int32_t> hops(static_cast<std::size_t>(grid.paddedStorageSize()), SearchSnapshot::kInfScore);
+    lowerHops(grid, seed, hops);
+    std::int32_t next = farthestSlot(hops);
+    if (next < 0) {
+        next = seed;
+    }
+    std::fill(hops.begin(), hops.end(), SearchSnapshot::kInfScore);
+
+    while (next >= 0 && static_cast<int>(landmarkSlots_.size()) < count) {
+        landmarkSlots_.push_back(next);
+        landmarks_.push_back(grid.fromPaddedIndex(next));
+        lowerHops(grid, next, hops);
+        next = farthestSlot(hops);
+    }
+}
+
+} // namespace pathcore
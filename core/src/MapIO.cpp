@@ -119,7 +119,8 @@ bool saveMapToFile(const Grid& grid, CellPos start, CellPos goal, const std::str
     return true;
 }
 
-std::optional<LoadedMap> loadMapFromFile(const std::string& filePath, MapIoError* err) {
+std::optional<LoadedMap> loadMapFromFile(const std::string& filePath, MapIoError* err,
+                                         IndexLayout layout) {
     if (filePath.empty()) {
         return failLoad(err, "Missing file path.");
     }
@@ -186,7 +187,7 @@ std::optional<LoadedMap> loadMapFromFile(const std::string& filePath, MapIoError
         return failLoad(err, "Start and goal must be different.");
     }
 
-    Grid grid(width, height, 1);
+    Grid grid(width, height, 1, layout);
     for (int y = 0; y < height; ++y) {
         if (!std::getline(in, line)) {
             return failLoad(err, "Unexpected end of file while reading grid data.");
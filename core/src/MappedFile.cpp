@@ -0,0 +1,98 @@
+#include "pathcore/MappedFile.h"
+
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pathcore {
+namespace {
+
+bool setError(std::string* err, const std::string& message) {
+    if (err) {
+        *err = message;
+    }
+    return false;
+}
+
+} // namespace
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filePath, std::string* err) {
+    close();
+    if (filePath.empty()) {
+        return setError(err, "Missing file path.");
+    }
+
+#if !defined(_WIN32)
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return setError(err, "Failed to open file for reading.");
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return setError(err, "File is empty or unreadable.");
+    }
+    void* mem = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        return setError(err, "Failed to map file.");
+    }
+    data_ = static_cast<const std::uint8_t*>(mem);
+    size_ = static_cast<std::size_t>(info.st_size);
+    mapped_ = true;
+    return true;
+#else
+    std::ifstream in(filePath, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return setError(err, "Failed to open file for reading.");
+    }
+    const std::streamsize length = in.tellg();
+    if (length <= 0) {
+        return setError(err, "File is empty or unreadable.");
+    }
+    buffer_.resize(static_cast<std::size_t>(length));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(buffer_.data()), length)) {
+        buffer_.clear();
+        return setError(err, "Failed while reading file.");
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#if !defined(_WIN32)
+    if (mapped_) {
+        ::munmap(const_cast<std::uint8_t*>(data_), size_);
+    }
+#endif
+    mapped_ = false;
+    data_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+}
+
+bool MappedFile::isOpen() const {
+    return data_ != nullptr;
+}
+
+const std::uint8_t* MappedFile::data() const {
+    return data_;
+}
+
+std::size_t MappedFile::size() const {
+    return size_;
+}
+
+} // namespace pathcore
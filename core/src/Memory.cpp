@@ -0,0 +1,69 @@
+#include "pathcore/Memory.h"
+
+namespace pathcore {
+
+CountingResource::CountingResource(std::pmr::memory_resource* upstream)
+    : upstream_(upstream) {
+}
+
+void CountingResource::resetCounters() {
+    allocations_ = 0;
+    deallocations_ = 0;
+    bytesAllocated_ = 0;
+}
+
+void* CountingResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* p = upstream_->allocate(bytes, alignment);
+    ++allocations_;
+    bytesAllocated_ += bytes;
+    bytesInUse_ += bytes;
+    return p;
+}
+
+void CountingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+    ++deallocations_;
+    bytesInUse_ -= bytes;
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+QueryArena::QueryArena(std::size_t initialBytes, std::pmr::memory_resource* upstream)
+    : overflow_(upstream)
+    , buffer_(initialBytes, upstream) {
+    rebuild();
+}
+
+std::pmr::memory_resource* QueryArena::resource() {
+    return &*pool_;
+}
+
+std::size_t QueryArena::capacity() const {
+    return buffer_.size();
+}
+
+void QueryArena::release() {
+    // Whatever the last query took beyond the buffer becomes part of it.
+    const std::size_t spilled = static_cast<std::size_t>(overflow_.bytesAllocated());
+    pool_.reset();
+    monotonic_.reset();
+    if (spilled > 0) {
+        const std::size_t grown = buffer_.size() + spilled;
+        buffer_ = std::pmr::vector<std::byte>(grown, buffer_.get_allocator());
+    }
+    overflow_.resetCounters();
+    rebuild();
+}
+
+void QueryArena::rebuild() {
+    if (buffer_.empty()) {
+        monotonic_.emplace(&overflow_);
+    } else {
+        monotonic_.emplace(buffer_.data(), buffer_.size(), &overflow_);
+    }
+    pool_.emplace(&*monotonic_);
+}
+
+} // namespace pathcore
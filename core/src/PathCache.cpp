@@ -0,0 +1,262 @@
+#include "pathcore/PathCache.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace pathcore {
+
+namespace {
+
+// Rough heap cost of the list node, the query map node and one index node per cell.
+constexpr std::size_t kNodeBytes = 4 * sizeof(void*);
+
+std::uint64_t mixKey(std::uint64_t h, std::uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+std::uint64_t cellBits(CellPos p) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(p.x)) << 32) | static_cast<std::uint32_t>(p.y);
+}
+
+int moveBetween(CellPos a, CellPos b) {
+    for (int dir = 0; dir < 8; ++dir) {
+        if (a.x + kDirDx[dir] == b.x && a.y + kDirDy[dir] == b.y) {
+            return dir;
+        }
+    }
+    return -1;
+}
+
+int moveAt(const std::vector<std::uint8_t>& moves, std::uint32_t i) {
+    const std::uint8_t byte = moves[i / 2];
+    return (i % 2 == 0) ? (byte & 0xF) : (byte >> 4);
+}
+
+} // namespace
+
+bool PathCache::QueryKey::operator==(const QueryKey& other) const {
+    return gridVersion == other.gridVersion && config == other.config && start == other.start && goal == other.goal;
+}
+
+std::size_t PathCache::QueryKeyHash::operator()(const QueryKey& key) const {
+    std::uint64_t h = mixKey(key.gridVersion, key.config);
+    h = mixKey(h, cellBits(key.start));
+    return static_cast<std::size_t>(mixKey(h, cellBits(key.goal)));
+}
+
+bool PathCache::CellKey::operator==(const CellKey& other) const {
+    return gridVersion == other.gridVersion && config == other.config && cell == other.cell;
+}
+
+std::size_t PathCache::CellKeyHash::operator()(const CellKey& key) const {
+    return static_cast<std::size_t>(mixKey(mixKey(key.gridVersion, key.config), cellBits(key.cell)));
+}
+
+PathCache::PathCache(const PathCacheOptions& options)
+    : options_(options) {
+}
+
+// markPath and the snapshot layout do not change the path, so they are not part of the key.
+std::uint64_t PathCache::configKey(const SearchConfig& config) {
+    std::uint64_t key = static_cast<std::uint64_t>(config.neighborMode);
+    key |= (config.useWeights ? 1ull : 0ull) << 1;
+    key |= (config.allowCornerCutting ? 1ull : 0ull) << 2;
+    if (config.penalizeTurns) {
+        key |= 1ull << 3;
+        key |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(config.turnPenalty)) << 8;
+    }
+    return key;
+}
+
+bool PathCache::lookup(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config, SearchPath* out) {
+    const QueryKey key{grid.version(), configKey(config), start, goal};
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.lookups;
+    const auto found = byQuery_.find(key);
+    if (found == byQuery_.end()) {
+        if (options_.subPaths && !config.penalizeTurns && sliceLookup(grid, key, config, out)) {
+            ++stats_.subPathHits;
+            return true;
+        }
+        return false;
+    }
+
+    const EntryList::iterator it = found->second;
+    lru_.splice(lru_.begin(), lru_, it);
+    ++stats_.hits;
+    if (out != nullptr) {
+        out->clear();
+        out->cells.reserve(it->length);
+        CellPos p = start;
+        out->cells.push_back(p);
+        for (std::uint32_t i = 0; i + 1 < it->length; ++i) {
+            const int dir = moveAt(it->moves, i);
+            p = CellPos{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+            out->cells.push_back(p);
+        }
+        out->cost = it->cost;
+    }
+    return true;
+}
+
+// Without turn penalties every move costs what the cell it enters costs, so a stretch of an
+// optimal path is optimal, and so is a stretch walked backwards: reversing any path between
+// two cells changes its cost by the same cost(start) - cost(goal).
+bool PathCache::sliceLookup(const Grid& grid, const QueryKey& key, const SearchConfig& config, SearchPath* out) {
+    const auto fromStart = byCell_.find(CellKey{key.gridVersion, key.config, key.start});
+    if (fromStart == byCell_.end()) {
+        return false;
+    }
+    const auto fromGoal = byCell_.find(CellKey{key.gridVersion, key.config, key.goal});
+    if (fromGoal == byCell_.end()) {
+        return false;
+    }
+    for (const Occurrence& s : fromStart->second) {
+        for (const Occurrence& g : fromGoal->second) {
+            if (s.entry != g.entry) {
+                continue;
+            }
+            const Entry& entry = *s.entry;
+            const std::uint32_t lo = std::min(s.pos, g.pos);
+            const std::uint32_t hi = std::max(s.pos, g.pos);
+            std::vector<CellPos> cells;
+            cells.reserve(hi - lo + 1);
+            CellPos p = s.pos < g.pos ? key.start : key.goal;
+            cells.push_back(p);
+            for (std::uint32_t i = lo; i < hi; ++i) {
+                const int dir = moveAt(entry.moves, i);
+                p = CellPos{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+                cells.push_back(p);
+            }
+            if (s.pos > g.pos) {
+                std::reverse(cells.begin(), cells.end());
+            }
+
+            lru_.splice(lru_.begin(), lru_, s.entry);
+            if (out != nullptr) {
+                out->clear();
+                std::int32_t cost = 0;
+                for (std::size_t i = 1; i < cells.size(); ++i) {
+                    cost += config.useWeights ? grid.cost(cells[i]) : 1;
+                }
+                out->cells.assign(cells.begin(), cells.end());
+                out->cost = cost;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void PathCache::insert(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config, const SearchPath& path) {
+    if (path.empty() || path.bound > 1.0 || path.cells.front() != start || path.cells.back() != goal) {
+        return;
+    }
+    Entry entry;
+    entry.key = QueryKey{grid.version(), configKey(config), start, goal};
+    entry.length = static_cast<std::uint32_t>(path.cells.size());
+    entry.cost = path.cost;
+    entry.moves.assign((path.cells.size() + 1) / 2, 0);
+    for (std::size_t i = 0; i + 1 < path.cells.size(); ++i) {
+        const int dir = moveBetween(path.cells[i], path.cells[i + 1]);
+        if (dir < 0) {
+            return;
+        }
+        entry.moves[i / 2] |= static_cast<std::uint8_t>(dir << ((i % 2) * 4));
+    }
+    entry.indexed = options_.subPaths && !config.penalizeTurns;
+    entry.bytes = sizeof(Entry) + kNodeBytes + entry.moves.capacity();
+    if (entry.indexed) {
+        entry.bytes += path.cells.size() * (sizeof(Occurrence) + sizeof(CellKey) + kNodeBytes);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entry.bytes > options_.maxBytes) {
+        return;
+    }
+    const auto existing = byQuery_.find(entry.key);
+    if (existing != byQuery_.end()) {
+        erase(existing->second);
+    }
+    lru_.push_front(std::move(entry));
+    const EntryList::iterator it = lru_.begin();
+    byQuery_.emplace(it->key, it);
+    if (it->indexed) {
+        for (std::size_t i = 0; i < path.cells.size(); ++i) {
+            byCell_[CellKey{it->key.gridVersion, it->key.config, path.cells[i]}].push_back(
+                Occurrence{it, static_cast<std::uint32_t>(i)});
+        }
+    }
+    stats_.bytes += it->bytes;
+    ++stats_.entries;
+    ++stats_.inserts;
+    evictToFit();
+}
+
+void PathCache::erase(EntryList::iterator it) {
+    if (it->indexed) {
+        CellPos p = it->key.start;
+        for (std::uint32_t i = 0; i < it->length; ++i) {
+            if (i > 0) {
+                const int dir = moveAt(it->moves, i - 1);
+                p = CellPos{p.x + kDirDx[dir], p.y + kDirDy[dir]};
+            }
+            const auto bucket = byCell_.find(CellKey{it->key.gridVersion, it->key.config, p});
+            if (bucket == byCell_.end()) {
+                continue;
+            }
+            std::vector<Occurrence>& list = bucket->second;
+            list.erase(std::remove_if(list.begin(), list.end(), [it](const Occurrence& o) { return o.entry == it; }),
+                list.end());
+            if (list.empty()) {
+                byCell_.erase(bucket);
+            }
+        }
+    }
+    byQuery_.erase(it->key);
+    stats_.bytes -= it->bytes;
+    --stats_.entries;
+    lru_.erase(it);
+}
+
+void PathCache::evictToFit() {
+    while (stats_.bytes > options_.maxBytes && !lru_.empty()) {
+        erase(std::prev(lru_.end()));
+        ++stats_.evictions;
+    }
+}
+
+void PathCache::dropOtherVersions(const Grid& grid) {
+    const std::uint64_t version = grid.version();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        const auto next = std::next(it);
+        if (it->key.gridVersion != version) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+void PathCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    byQuery_.clear();
+    byCell_.clear();
+    stats_.bytes = 0;
+    stats_.entries = 0;
+}
+
+void PathCache::setMaxBytes(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_.maxBytes = bytes;
+    evictToFit();
+}
+
+PathCacheStats PathCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace pathcore
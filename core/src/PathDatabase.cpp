@@ -0,0 +1,374 @@
+#include "pathcore/PathDatabase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "pathcore/NodeState.h"
+#include "pathcore/SearchSnapshot.h"
+
+namespace pathcore {
+
+// File layout: the header, then (cells + 1) row offsets into the run array, then the runs. A run is
+// (first target index << 4) | move, move 0-7 being a direction code and kNoMove "unreachable".
+struct PathDatabaseHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint8_t neighborMode;
+    std::uint8_t useWeights;
+    std::uint8_t allowCornerCutting;
+    std::uint8_t reserved;
+    std::uint64_t fingerprint; // Grid::contentHash()
+    std::uint64_t runCount;
+};
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'V', 'C', 'P', 'D', 'B', '\0', '\0'};
+constexpr std::uint32_t kVersion = 2;
+constexpr std::uint32_t kNoMove = 0xF;
+constexpr std::uint32_t kMoveBits = 4;
+constexpr std::uint32_t kMaxTargets = 1u << (32 - kMoveBits);
+
+bool setError(PathDatabaseError* err, const std::string& message) {
+    if (err) {
+        err->message = message;
+    }
+    return false;
+}
+
+// One Dijkstra from `source` (a padded slot) recording, for every reached slot, the direction of
+// the first move on its shortest path. Move costs are small integers (at most `maxStep`), so a
+// ring of maxStep + 1 buckets (Dial's algorithm) stands in for the heap.
+void firstMoves(const Grid& grid, const SearchConfig& config, std::int32_t source, std::int32_t maxStep,
+    std::vector<std::int32_t>& dist, std::vector<std::uint8_t>& first,
+    std::vector<std::vector<std::int32_t>>& buckets) {
+    const std::int32_t* costs = grid.paddedCosts();
+    dist.assign(static_cast<std::size_t>(grid.paddedStorageSize()), SearchSnapshot::kInfScore);
+    first.assign(dist.size(), static_cast<std::uint8_t>(kNoMove));
+    const std::size_t ring = static_cast<std::size_t>(maxStep) + 1;
+    buckets.resize(ring);
+    for (auto& bucket : buckets) {
+        bucket.clear();
+    }
+
+    dist[static_cast<std::size_t>(source)] = 0;
+    buckets[0].push_back(source);
+    std::size_t pending = 1;
+
+    const bool eightWay = config.neighborMode == NeighborMode::Eight;
+    for (std::int32_t d = 0; pending > 0; ++d) {
+        std::vector<std::int32_t>& bucket = buckets[static_cast<std::size_t>(d) % ring];
+        while (!bucket.empty()) {
+            const std::int32_t slot = bucket.back();
+            bucket.pop_back();
+            --pending;
+            if (dist[static_cast<std::size_t>(slot)] != d) {
+                continue;
+            }
+            const int* deltas = grid.neighborDeltas(slot);
+            for (int dir = 0; dir < 8; ++dir) {
+                const bool diagonal = (dir & 1) != 0;
+                if (diagonal && !eightWay) {
+                    continue;
+                }
+                const std::int32_t n = slot + deltas[dir];
+                if (costs[n] == 0) {
+                    continue;
+                }
+                if (diagonal && !config.allowCornerCutting
+                    && (costs[slot + deltas[(dir + 7) & 7]] == 0 || costs[slot + deltas[(dir + 1) & 7]] == 0)) {
+                    continue;
+                }
+                // Steps are at least 1, so `n` never lands in the bucket being drained.
+                const std::int32_t nd = d + (config.useWeights ? costs[n] : 1);
+                if (nd < dist[static_cast<std::size_t>(n)]) {
+                    dist[static_cast<std::size_t>(n)] = nd;
+                    first[static_cast<std::size_t>(n)] = slot == source
+                        ? static_cast<std::uint8_t>(dir)
+                        : first[static_cast<std::size_t>(slot)];
+                    buckets[static_cast<std::size_t>(nd) % ring].push_back(n);
+                    ++pending;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool buildPathDatabase(const Grid& grid,
+    const SearchConfig& config,
+    const std::string& filePath,
+    int threads,
+    PathDatabaseError* err) {
+    if (filePath.empty()) {
+        return setError(err, "Missing file path.");
+    }
+    if (grid.width() <= 0 || grid.height() <= 0) {
+        return setError(err, "Grid has invalid dimensions.");
+    }
+    if (config.penalizeTurns) {
+        return setError(err, "Path databases do not support turn penalties.");
+    }
+    const IndexMap targetOrder(grid.width(), grid.height(), IndexLayout::Tiled);
+    if (static_cast<std::uint64_t>(targetOrder.storageSize()) >= kMaxTargets) {
+        return setError(err, "Grid is too large for a path database.");
+    }
+
+    const int cells = grid.width() * grid.height();
+    std::vector<std::vector<std::uint32_t>> rows(static_cast<std::size_t>(cells));
+
+    std::int32_t maxStep = 1;
+    if (config.useWeights) {
+        const std::int32_t* costs = grid.paddedCosts();
+        maxStep = *std::max_element(costs, costs + grid.paddedStorageSize());
+    }
+
+    // Padded slot of every target in run order, -1 for walls and tile padding.
+    std::vector<std::int32_t> targetSlots(static_cast<std::size_t>(targetOrder.storageSize()), -1);
+    for (int t = 0; t < targetOrder.storageSize(); ++t) {
+        const CellPos target = targetOrder.fromIndex(t);
+        if (grid.inBounds(target) && !grid.isBlocked(target)) {
+            targetSlots[static_cast<std::size_t>(t)] = grid.paddedIndex(target);
+        }
+    }
+
+    constexpr int kChunk = 64;
+    std::atomic<int> nextSource{0};
+    auto worker = [&]() {
+        std::vector<std::int32_t> dist;
+        std::vector<std::uint8_t> first;
+        std::vector<std::vector<std::int32_t>> buckets;
+        for (int begin = nextSource.fetch_add(kChunk); begin < cells; begin = nextSource.fetch_add(kChunk)) {
+            const int end = std::min(cells, begin + kChunk);
+            for (int s = begin; s < end; ++s) {
+                const CellPos source{s % grid.width(), s / grid.width()};
+                if (grid.isBlocked(source)) {
+                    continue;
+                }
+                const std::int32_t sourceSlot = grid.paddedIndex(source);
+                firstMoves(grid, config, sourceSlot, maxStep, dist, first, buckets);
+                std::vector<std::uint32_t>& row = rows[static_cast<std::size_t>(s)];
+                for (int t = 0; t < targetOrder.storageSize(); ++t) {
+                    const std::int32_t slot = targetSlots[static_cast<std::size_t>(t)];
+                    if (slot < 0 || slot == sourceSlot) {
+                        continue;
+                    }
+                    const std::uint32_t move = first[static_cast<std::size_t>(slot)];
+                    if (row.empty()) {
+                        // The first run always starts at 0 so every lookup lands in a run.
+                        row.push_back(move);
+                    } else if ((row.back() & kNoMove) != move) {
+                        row.push_back((static_cast<std::uint32_t>(t) << kMoveBits) | move);
+                    }
+                }
+                row.shrink_to_fit();
+            }
+        }
+    };
+
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threads = std::max(1, threads);
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    std::vector<std::uint64_t> rowStart(static_cast<std::size_t>(cells) + 1, 0);
+    for (int s = 0; s < cells; ++s) {
+        rowStart[static_cast<std::size_t>(s) + 1] = rowStart[static_cast<std::size_t>(s)] + rows[static_cast<std::size_t>(s)].size();
+    }
+
+    PathDatabaseHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.width = static_cast<std::uint32_t>(grid.width());
+    header.height = static_cast<std::uint32_t>(grid.height());
+    header.neighborMode = static_cast<std::uint8_t>(config.neighborMode);
+    header.useWeights = config.useWeights ? 1 : 0;
+    header.allowCornerCutting = config.allowCornerCutting ? 1 : 0;
+    header.fingerprint = grid.contentHash();
+    header.runCount = rowStart.back();
+
+    std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return setError(err, "Failed to open file for writing.");
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(rowStart.data()),
+        static_cast<std::streamsize>(rowStart.size() * sizeof(std::uint64_t)));
+    for (const auto& row : rows) {
+        out.write(reinterpret_cast<const char*>(row.data()),
+            static_cast<std::streamsize>(row.size() * sizeof(std::uint32_t)));
+    }
+    if (!out) {
+        return setError(err, "Failed while writing path database.");
+    }
+    return true;
+}
+
+bool PathDatabase::open(const std::string& filePath, PathDatabaseError* err) {
+    close();
+    std::string ioErr;
+    if (!file_.open(filePath, &ioErr)) {
+        return setError(err, ioErr);
+    }
+    if (file_.size() < sizeof(PathDatabaseHeader)) {
+        close();
+        return setError(err, "File is too small to be a path database.");
+    }
+    const PathDatabaseHeader* header = reinterpret_cast<const PathDatabaseHeader*>(file_.data());
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+        close();
+        return setError(err, "Invalid path database header.");
+    }
+    const std::uint64_t cells = static_cast<std::uint64_t>(header->width) * header->height;
+    if (cells == 0 || cells > kMaxTargets || header->runCount > file_.size() / sizeof(std::uint32_t)) {
+        close();
+        return setError(err, "Invalid path database header.");
+    }
+    const std::uint64_t expected = sizeof(PathDatabaseHeader) + (cells + 1) * sizeof(std::uint64_t)
+        + header->runCount * sizeof(std::uint32_t);
+    if (file_.size() < expected) {
+        close();
+        return setError(err, "Path database is truncated.");
+    }
+
+    // firstMove() trusts the offsets and reads the run before the target's, so every row must
+    // lie inside the run table and start with the run of target 0.
+    const std::uint64_t* rowStart = reinterpret_cast<const std::uint64_t*>(file_.data() + sizeof(PathDatabaseHeader));
+    const std::uint32_t* runs = reinterpret_cast<const std::uint32_t*>(rowStart + cells + 1);
+    if (rowStart[0] != 0 || rowStart[cells] > header->runCount) {
+        close();
+        return setError(err, "Path database row table is corrupt.");
+    }
+    for (std::uint64_t row = 0; row < cells; ++row) {
+        if (rowStart[row + 1] < rowStart[row]
+            || (rowStart[row + 1] > rowStart[row] && (runs[rowStart[row]] >> kMoveBits) != 0)) {
+            close();
+            return setError(err, "Path database row table is corrupt.");
+        }
+    }
+
+    header_ = header;
+    rowStart_ = rowStart;
+    runs_ = runs;
+    targetOrder_ = IndexMap(static_cast<int>(header->width), static_cast<int>(header->height), IndexLayout::Tiled);
+    return true;
+}
+
+void PathDatabase::close() {
+    file_.close();
+    header_ = nullptr;
+    rowStart_ = nullptr;
+    runs_ = nullptr;
+    targetOrder_ = IndexMap();
+}
+
+bool PathDatabase::isOpen() const {
+    return header_ != nullptr;
+}
+
+bool PathDatabase::matches(const Grid& grid, const SearchConfig& config) const {
+    if (!isOpen() || config.penalizeTurns) {
+        return false;
+    }
+    if (static_cast<int>(header_->width) != grid.width() || static_cast<int>(header_->height) != grid.height()) {
+        return false;
+    }
+    if (header_->neighborMode != static_cast<std::uint8_t>(config.neighborMode)
+        || (header_->useWeights != 0) != config.useWeights
+        || (header_->allowCornerCutting != 0) != config.allowCornerCutting) {
+        return false;
+    }
+    return header_->fingerprint == grid.contentHash();
+}
+
+int PathDatabase::firstMove(CellPos from, CellPos to) const {
+    if (!isOpen()) {
+        return -1;
+    }
+    const int width = static_cast<int>(header_->width);
+    const int height = static_cast<int>(header_->height);
+    if (!pathcore::inBounds(width, height, from) || !pathcore::inBounds(width, height, to)) {
+        return -1;
+    }
+    const std::size_t row = static_cast<std::size_t>(from.y) * header_->width + static_cast<std::size_t>(from.x);
+    const std::uint32_t* begin = runs_ + rowStart_[row];
+    const std::uint32_t* end = runs_ + rowStart_[row + 1];
+    if (begin == end) {
+        return -1;
+    }
+    const std::uint32_t target = static_cast<std::uint32_t>(targetOrder_.toIndex(to));
+    // Last run starting at or before the target.
+    const std::uint32_t* it = std::upper_bound(begin, end, target,
+        [](std::uint32_t t, std::uint32_t run) { return t < (run >> kMoveBits); });
+    const std::uint32_t move = *(it - 1) & kNoMove;
+    return move > 7 ? -1 : static_cast<int>(move);
+}
+
+bool PathDatabase::reset(const Grid& grid, CellPos start, CellPos goal, const SearchConfig& config) {
+    if (!commonReset(grid, start, goal, config)) {
+        return false;
+    }
+    if (!matches(grid, config)) {
+        status_ = SearchStatus::NotStarted;
+        return false;
+    }
+    if (status_ != SearchStatus::Running) {
+        return true;
+    }
+
+    const std::int32_t* costs = grid.paddedCosts();
+    const std::int32_t startIdx = static_cast<std::int32_t>(grid.paddedIndex(start));
+    const std::int32_t goalIdx = static_cast<std::int32_t>(grid.paddedIndex(goal));
+    hot_[static_cast<std::size_t>(startIdx)].g = 0;
+    setState(startIdx, NodeState::Closed);
+
+    CellPos cur = start;
+    std::int32_t curIdx = startIdx;
+    const int limit = grid.width() * grid.height();
+    for (int steps = 0; cur != goal && steps < limit; ++steps) {
+        const int dir = firstMove(cur, goal);
+        if (dir < 0) {
+            break;
+        }
+        const std::int32_t nextIdx = curIdx + grid.neighborDeltas(curIdx)[dir];
+        if (costs[nextIdx] == 0) {
+            break;
+        }
+        HotNode& next = hot_[static_cast<std::size_t>(nextIdx)];
+        next.g = hot_[static_cast<std::size_t>(curIdx)].g + (config_.useWeights ? costs[nextIdx] : 1);
+        next.dir = static_cast<std::uint8_t>(dir);
+        setState(nextIdx, NodeState::Closed);
+        cur = CellPos{cur.x + kDirDx[dir], cur.y + kDirDy[dir]};
+        curIdx = nextIdx;
+    }
+
+    if (cur == goal) {
+        status_ = SearchStatus::Found;
+        rebuildPath(startIdx, goalIdx);
+    } else {
+        status_ = SearchStatus::NoPath;
+    }
+    return true;
+}
+
+SearchStatus PathDatabase::step(std::size_t iterations) {
+    (void)iterations;
+    return status_;
+}
+
+} // namespace pathcore
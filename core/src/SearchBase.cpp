@@ -0,0 +1,169 @@
+#include "pathcore/SearchBase.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "pathcore/SearchWorkspace.h"
+
+namespace pathcore {
+
+namespace {
+
+// polymorphic_allocator does not propagate on swap, so vectors on different resources trade
+// contents by move assignment, which copies element-wise and leaves each on its own resource.
+template <typename T>
+void exchangeBuffers(std::pmr::vector<T>& a, std::pmr::vector<T>& b) {
+    if (a.get_allocator() == b.get_allocator()) {
+        a.swap(b);
+        return;
+    }
+    std::pmr::vector<T> held(std::move(a));
+    a = std::move(b);
+    b = std::move(held);
+}
+
+} // namespace
+
+SearchBase::SearchBase(std::pmr::memory_resource* upstream)
+    : path_(upstream)
+    , hot_(upstream)
+    , open_(upstream)
+    , dirty_(upstream)
+    , queryArena_(0, upstream) {
+}
+
+SearchBase::~SearchBase() {
+    if (workspace_ != nullptr) {
+        swapBuffers(*workspace_);
+        workspace_->lent_ = false;
+    }
+}
+
+void SearchBase::setWorkspace(SearchWorkspace* workspace) {
+    if (workspace == workspace_) {
+        return;
+    }
+    if (workspace_ != nullptr) {
+        swapBuffers(*workspace_);
+        workspace_->lent_ = false;
+    }
+    workspace_ = workspace;
+    if (workspace_ != nullptr) {
+        assert(!workspace_->lent_);
+        swapBuffers(*workspace_);
+        workspace_->lent_ = true;
+    }
+
+    // The buffers no longer describe the search they were filled by.
+    grid_ = nullptr;
+    status_ = SearchStatus::NotStarted;
+    path_.clear();
+    open_.clear();
+    dirty_.clear();
+    snapshotStale_ = true;
+}
+
+void SearchBase::swapBuffers(SearchWorkspace& workspace) {
+    exchangeBuffers(hot_, workspace.hot_);
+    exchangeBuffers(open_, workspace.open_);
+    exchangeBuffers(dirty_, workspace.dirty_);
+    std::swap(snapshot_, workspace.snapshot_);
+    std::swap(path_.cost, workspace.path_.cost);
+    std::swap(path_.bound, workspace.path_.bound);
+    exchangeBuffers(path_.cells, workspace.path_.cells);
+}
+
+void SearchBase::rebuildPath(std::int32_t startIdx, std::int32_t goalIdx) {
+    path_.clear();
+    if (goalIdx < 0 || goalIdx >= cellCount()) {
+        return;
+    }
+
+    std::int32_t cur = goalIdx;
+    int steps = 0;
+    const int limit = cellCount();
+    const Grid& g = grid();
+
+    while (cur != SearchSnapshot::kNoParent && cur != startIdx && steps < limit) {
+        path_.cells.push_back(g.fromPaddedIndex(cur));
+        cur = parentOf(cur);
+        ++steps;
+    }
+
+    if (cur == startIdx) {
+        path_.cells.push_back(g.fromPaddedIndex(startIdx));
+        std::reverse(path_.cells.begin(), path_.cells.end());
+        path_.cost = hot_[static_cast<std::size_t>(goalIdx)].g;
+    } else {
+        path_.cells.clear();
+    }
+
+    if (!config_.markPath) {
+        return;
+    }
+    for (const CellPos& p : path_.cells) {
+        setState(static_cast<std::int32_t>(g.paddedIndex(p)), NodeState::Path);
+    }
+    setState(goalIdx, NodeState::Path);
+}
+
+void SearchBase::clearPathMarks() {
+    const Grid& g = grid();
+    auto unmark = [&](CellPos p) {
+        const std::int32_t slot = static_cast<std::int32_t>(g.paddedIndex(p));
+        if (hot_[static_cast<std::size_t>(slot)].state == NodeState::Path) {
+            setState(slot, NodeState::Closed);
+        }
+    };
+    for (const CellPos& p : path_.cells) {
+        unmark(p);
+    }
+    unmark(goal_);
+    path_.clear();
+}
+
+void SearchBase::syncSnapshot() const {
+    if (snapshotStale_) {
+        snapshotStale_ = false;
+        dirty_.clear();
+        if (grid_ == nullptr) {
+            snapshot_.resize(0, 0);
+            return;
+        }
+        snapshot_.resize(grid_->width(), grid_->height(), config_.snapshotLayout, grid_->layout());
+        for (std::int32_t slot = 0; slot < cellCount(); ++slot) {
+            if (hot_[static_cast<std::size_t>(slot)].state != NodeState::Unseen) {
+                copyCell(slot);
+            }
+        }
+        return;
+    }
+
+    for (const std::int32_t idx : dirty_) {
+        copyCell(idx);
+    }
+    dirty_.clear();
+}
+
+void SearchBase::copyCell(std::int32_t slot) const {
+    const HotNode& hot = hot_[static_cast<std::size_t>(slot)];
+    const std::int32_t idx = static_cast<std::int32_t>(grid_->toIndex(grid_->fromPaddedIndex(slot)));
+    std::int32_t parent = parentOf(slot);
+    if (parent != SearchSnapshot::kNoParent) {
+        parent = static_cast<std::int32_t>(grid_->toIndex(grid_->fromPaddedIndex(parent)));
+    }
+    snapshot_.setStateAt(idx, hot.state);
+    snapshot_.setGAt(idx, hot.g);
+    snapshot_.setParentAt(idx, parent);
+    const bool hasF = fScores_ != nullptr && static_cast<std::size_t>(slot) < fScores_->size();
+    snapshot_.setFAt(idx, hasF ? (*fScores_)[static_cast<std::size_t>(slot)] : SearchSnapshot::kInfScore);
+}
+
+// Called before the state changes, once the engine has written the cell's g and parent.
+void SearchBase::recordState(std::int32_t slot, NodeState to) {
+    const HotNode& hot = hot_[static_cast<std::size_t>(slot)];
+    const int parentDir = hot.dir == kNoDir ? -1 : (hot.dir + 4) & 7;
+    recorder_->record(slot, to, hot.g, parentDir);
+}
+
+} // namespace pathcore
@@ -0,0 +1,71 @@
+#include "pathcore/SearchProfile.h"
+
+#include <algorithm>
+
+namespace pathcore {
+
+void SearchProfile::begin(const Grid& grid) {
+    width_ = grid.width();
+    height_ = grid.height();
+    padded_ = grid.paddedIndexMap();
+    pad_ = grid.padding();
+    cells_.assign(static_cast<std::size_t>(grid.paddedStorageSize()), CellCounters{});
+    std::fill(std::begin(totals_), std::end(totals_), 0);
+}
+
+void SearchProfile::clear() {
+    width_ = 0;
+    height_ = 0;
+    cells_.clear();
+    std::fill(std::begin(totals_), std::end(totals_), 0);
+}
+
+bool SearchProfile::valid() const {
+    return width_ > 0 && height_ > 0;
+}
+
+int SearchProfile::width() const {
+    return width_;
+}
+
+int SearchProfile::height() const {
+    return height_;
+}
+
+std::int64_t SearchProfile::read(const CellCounters& cell, ProfileCounter counter) {
+    switch (counter) {
+    case ProfileCounter::ExpansionOrder:
+        return cell.firstExpansion;
+    case ProfileCounter::Expansions:
+        return cell.expansions;
+    case ProfileCounter::Pushes:
+        return cell.pushes;
+    case ProfileCounter::StalePops:
+        return cell.stalePops;
+    case ProfileCounter::Reopens:
+        return cell.reopens;
+    }
+    return 0;
+}
+
+std::int64_t SearchProfile::value(ProfileCounter counter, CellPos p) const {
+    if (!valid() || !pathcore::inBounds(width_, height_, p)) {
+        return counter == ProfileCounter::ExpansionOrder ? kNotExpanded : 0;
+    }
+    const int slot = padded_.toIndex(CellPos{p.x + pad_, p.y + pad_});
+    return read(cells_[static_cast<std::size_t>(slot)], counter);
+}
+
+std::int64_t SearchProfile::maxValue(ProfileCounter counter) const {
+    std::int64_t best = counter == ProfileCounter::ExpansionOrder ? kNotExpanded : 0;
+    for (const CellCounters& cell : cells_) {
+        best = std::max(best, read(cell, counter));
+    }
+    return best;
+}
+
+std::uint64_t SearchProfile::total(ProfileCounter counter) const {
+    return totals_[static_cast<std::size_t>(counter)];
+}
+
+} // namespace pathcore
@@ -0,0 +1,166 @@
+#include "pathcore/SearchRecorder.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace pathcore {
+
+namespace {
+
+constexpr std::uint8_t kUnseenCell = static_cast<std::uint8_t>(SearchRecorder::kNoParentDir << 4);
+
+} // namespace
+
+SearchRecorder::SearchRecorder(const RecorderOptions& options)
+    : options_(options) {
+}
+
+void SearchRecorder::begin(const Grid& grid, const SearchConfig& config) {
+    recycleAll();
+    width_ = grid.width();
+    height_ = grid.height();
+    layout_ = grid.layout();
+    snapshotLayout_ = config.snapshotLayout;
+    padded_ = grid.paddedIndexMap();
+    pad_ = grid.padding();
+    const std::size_t slots = static_cast<std::size_t>(grid.paddedStorageSize());
+    interval_ = std::max<std::size_t>(std::min(std::max(options_.keyframeInterval, slots * 2),
+                                          options_.maxDeltas / 2),
+        1);
+    state_.assign(slots, kUnseenCell);
+    g_.assign(slots, SearchSnapshot::kInfScore);
+}
+
+void SearchRecorder::clear() {
+    recycleAll();
+    width_ = 0;
+    height_ = 0;
+    state_.clear();
+    g_.clear();
+}
+
+void SearchRecorder::recycleAll() {
+    while (!segments_.empty()) {
+        spare_.push_back(std::move(segments_.back()));
+        segments_.pop_back();
+    }
+    steps_ = 0;
+    kept_ = 0;
+}
+
+void SearchRecorder::startSegment() {
+    Segment segment;
+    if (!spare_.empty()) {
+        segment = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    segment.firstStep = steps_;
+    if (steps_ == 0) {
+        segment.keyState.clear();
+        segment.keyG.clear();
+    } else {
+        segment.keyState.assign(state_.begin(), state_.end());
+        segment.keyG.assign(g_.begin(), g_.end());
+    }
+    segment.deltas.clear();
+    segment.count = 0;
+    segment.lastSlot = 0;
+    segments_.push_back(std::move(segment));
+
+    while (kept_ > options_.maxDeltas && segments_.size() > 1) {
+        kept_ -= segments_.front().count;
+        spare_.push_back(std::move(segments_.front()));
+        segments_.pop_front();
+    }
+}
+
+void SearchRecorder::replay(const Segment& segment, std::size_t count, std::uint8_t* state, std::int32_t* g) {
+    const std::uint8_t* in = segment.deltas.data();
+    auto varint = [&in]() {
+        std::uint32_t v = 0;
+        for (int shift = 0;; shift += 7) {
+            const std::uint8_t byte = *in++;
+            v |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return v;
+            }
+        }
+    };
+    std::int32_t slot = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint8_t header = *in++;
+        const std::uint32_t step = varint();
+        slot += static_cast<std::int32_t>((step >> 1) ^ (0u - (step & 1)));
+        const std::size_t at = static_cast<std::size_t>(slot);
+        state[at] = static_cast<std::uint8_t>((header & 0x3) | ((header >> 2) & 0xF) << 4);
+        if ((header & kGChanged) != 0) {
+            g[at] = static_cast<std::int32_t>(varint());
+        }
+    }
+}
+
+bool SearchRecorder::recording() const {
+    return width_ > 0 && height_ > 0;
+}
+
+std::uint64_t SearchRecorder::firstStep() const {
+    return segments_.empty() ? steps_ : segments_.front().firstStep;
+}
+
+std::uint64_t SearchRecorder::stepCount() const {
+    return steps_;
+}
+
+std::size_t SearchRecorder::memoryBytes() const {
+    std::size_t bytes = state_.capacity() + g_.capacity() * sizeof(std::int32_t);
+    auto add = [&bytes](const Segment& segment) {
+        bytes += segment.keyState.capacity() + segment.keyG.capacity() * sizeof(std::int32_t)
+            + segment.deltas.capacity();
+    };
+    std::for_each(segments_.begin(), segments_.end(), add);
+    std::for_each(spare_.begin(), spare_.end(), add);
+    return bytes;
+}
+
+bool SearchRecorder::reconstruct(std::uint64_t step, SearchSnapshot* out) const {
+    if (out == nullptr || !recording() || step < firstStep() || step > steps_) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> state(state_.size(), kUnseenCell);
+    std::vector<std::int32_t> g(g_.size(), SearchSnapshot::kInfScore);
+    if (!segments_.empty()) {
+        // Last segment starting at or before `step`.
+        const auto it = std::prev(std::upper_bound(segments_.begin(), segments_.end(), step,
+            [](std::uint64_t s, const Segment& segment) { return s < segment.firstStep; }));
+        if (!it->keyState.empty()) {
+            state.assign(it->keyState.begin(), it->keyState.end());
+            g.assign(it->keyG.begin(), it->keyG.end());
+        }
+        replay(*it, static_cast<std::size_t>(step - it->firstStep), state.data(), g.data());
+    }
+
+    out->resize(width_, height_, snapshotLayout_, layout_);
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            const std::size_t slot = static_cast<std::size_t>(padded_.toIndex(CellPos{x + pad_, y + pad_}));
+            const NodeState s = static_cast<NodeState>(state[slot] & 0x3u);
+            if (s == NodeState::Unseen) {
+                continue;
+            }
+            const std::int32_t idx = static_cast<std::int32_t>(out->index.toIndex(CellPos{x, y}));
+            out->setStateAt(idx, s);
+            out->setGAt(idx, g[slot]);
+            const int dir = state[slot] >> 4;
+            if (dir != kNoParentDir) {
+                const CellPos parent{x + kDirDx[dir], y + kDirDy[dir]};
+                if (out->inBounds(parent)) {
+                    out->setParentAt(idx, static_cast<std::int32_t>(out->index.toIndex(parent)));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace pathcore
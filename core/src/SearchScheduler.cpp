@@ -0,0 +1,238 @@
+#include "pathcore/SearchScheduler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace pathcore {
+
+SearchScheduler::SearchScheduler(const Grid& grid, Factory factory, const SchedulerOptions& options)
+    : grid_(&grid)
+    , factory_(std::move(factory))
+    , options_(options) {
+    options_.maxInFlight = std::max<std::size_t>(options_.maxInFlight, 1);
+    options_.slice = std::max<std::size_t>(options_.slice, 1);
+    options_.agingFrames = std::max<std::uint32_t>(options_.agingFrames, 1);
+}
+
+void SearchScheduler::setComponentLabels(const ComponentLabels* labels) {
+    components_ = labels;
+    for (Job& job : running_) {
+        job.search->setComponentLabels(labels);
+    }
+}
+
+void SearchScheduler::setPathCache(PathCache* cache) {
+    cache_ = cache;
+}
+
+std::size_t SearchScheduler::waitingCount() const {
+    return waiting_.size();
+}
+
+std::size_t SearchScheduler::inFlightCount() const {
+    return running_.size();
+}
+
+const SchedulerStats& SearchScheduler::stats() const {
+    return stats_;
+}
+
+std::vector<SearchResult> SearchScheduler::takeResults() {
+    std::vector<SearchResult> out;
+    out.swap(results_);
+    return out;
+}
+
+std::uint64_t SearchScheduler::submit(const SearchRequest& request) {
+    Job job;
+    job.id = nextId_++;
+    job.request = request;
+    job.submitted = std::chrono::steady_clock::now();
+    job.submitFrame = frame_;
+    waiting_.push_back(std::move(job));
+    ++stats_.submitted;
+    return waiting_.back().id;
+}
+
+bool SearchScheduler::cancel(std::uint64_t id) {
+    auto matches = [id](const Job& job) { return job.id == id; };
+    auto waiting = std::find_if(waiting_.begin(), waiting_.end(), matches);
+    if (waiting != waiting_.end()) {
+        finish(*waiting, SearchStatus::Cancelled);
+        waiting_.erase(waiting);
+        return true;
+    }
+    auto running = std::find_if(running_.begin(), running_.end(), matches);
+    if (running != running_.end()) {
+        finish(*running, SearchStatus::Cancelled);
+        running_.erase(running);
+        return true;
+    }
+    return false;
+}
+
+double SearchScheduler::effectivePriority(const Job& job) const {
+    const double age = static_cast<double>(frame_ - job.submitFrame) / options_.agingFrames;
+    return static_cast<double>(job.request.priority) + age;
+}
+
+void SearchScheduler::sortByPriority(std::vector<Job>& jobs) const {
+    // Stable, so equal priorities keep submission order.
+    std::stable_sort(jobs.begin(), jobs.end(), [this](const Job& a, const Job& b) {
+        return effectivePriority(a) > effectivePriority(b);
+    });
+}
+
+// reset() clears per-cell arrays, so admitting is not free: it also stops at the deadline.
+void SearchScheduler::admit(const std::chrono::steady_clock::time_point* deadline) {
+    if (waiting_.empty() || running_.size() >= options_.maxInFlight) {
+        return;
+    }
+    sortByPriority(waiting_);
+    std::size_t taken = 0;
+    while (taken < waiting_.size() && running_.size() < options_.maxInFlight) {
+        if (deadline != nullptr && std::chrono::steady_clock::now() >= *deadline) {
+            break;
+        }
+        Job& job = waiting_[taken++];
+        if (cache_ != nullptr) {
+            SearchPath cached;
+            if (cache_->lookup(*grid_, job.request.start, job.request.goal, job.request.config, &cached)) {
+                ++stats_.cacheHits;
+                finish(job, SearchStatus::Found, &cached);
+                continue;
+            }
+        }
+        if (idle_.empty()) {
+            job.search = factory_();
+        } else {
+            job.search = std::move(idle_.back());
+            idle_.pop_back();
+        }
+        job.search->setComponentLabels(components_);
+        const SearchRequest& r = job.request;
+        if (!job.search->reset(*grid_, r.start, r.goal, r.config)) {
+            finish(job, SearchStatus::NotStarted);
+            continue;
+        }
+        if (job.search->status() != SearchStatus::Running) {
+            // Answered by reset() itself (e.g. different components).
+            finish(job, job.search->status());
+            continue;
+        }
+        running_.push_back(std::move(job));
+    }
+    waiting_.erase(waiting_.begin(), waiting_.begin() + static_cast<std::ptrdiff_t>(taken));
+}
+
+void SearchScheduler::finish(Job& job, SearchStatus status, const SearchPath* cached) {
+    const auto now = std::chrono::steady_clock::now();
+    SearchResult result;
+    result.id = job.id;
+    result.status = status;
+    if (cached != nullptr) {
+        result.path = *cached;
+    } else if (job.search && status == SearchStatus::Found) {
+        result.path = job.search->path();
+        if (cache_ != nullptr) {
+            const SearchRequest& r = job.request;
+            cache_->insert(*grid_, r.start, r.goal, r.config, result.path);
+        }
+    }
+    result.latency = now - job.submitted;
+    result.queued = (job.frames > 0 ? job.firstSlice : now) - job.submitted;
+    result.frames = job.frames;
+    result.expansions = job.expansions;
+    results_.push_back(std::move(result));
+
+    if (status == SearchStatus::Cancelled) {
+        ++stats_.cancelled;
+    } else if (status == SearchStatus::NotStarted) {
+        ++stats_.rejected;
+    } else {
+        ++stats_.completed;
+        stats_.totalLatency += results_.back().latency;
+        stats_.maxLatency = std::max(stats_.maxLatency, results_.back().latency);
+    }
+    if (job.search) {
+        idle_.push_back(std::move(job.search));
+    }
+    job.done = true;
+}
+
+std::size_t SearchScheduler::runFrame(const FrameBudget& budget) {
+    using Clock = std::chrono::steady_clock;
+    ++frame_;
+    ++stats_.frames;
+    const bool timed = budget.time > Clock::duration::zero();
+    const bool capped = budget.expansions > 0;
+    const Clock::time_point deadline = Clock::now() + budget.time;
+
+    admit(timed ? &deadline : nullptr);
+    std::size_t spent = 0;
+    bool outOfBudget = false;
+    while (!running_.empty() && !outOfBudget) {
+        sortByPriority(running_);
+        std::vector<double> weights(running_.size());
+        double totalWeight = 0.0;
+        for (std::size_t i = 0; i < running_.size(); ++i) {
+            weights[i] = std::max(1.0, 1.0 + effectivePriority(running_[i]));
+            totalWeight += weights[i];
+        }
+
+        // One round: every in-flight search gets a share proportional to its weight.
+        const std::size_t roundBudget = capped ? budget.expansions - spent : 0;
+        for (std::size_t i = 0; i < running_.size(); ++i) {
+            std::size_t slice = 0;
+            if (capped) {
+                const std::size_t left = budget.expansions - spent;
+                if (left == 0) {
+                    outOfBudget = true;
+                    break;
+                }
+                const double share = static_cast<double>(roundBudget) * weights[i] / totalWeight;
+                slice = std::min(left, std::max(options_.slice, static_cast<std::size_t>(share)));
+            } else {
+                slice = options_.slice * static_cast<std::size_t>(weights[i]);
+            }
+
+            Job& job = running_[i];
+            if (job.frames == 0) {
+                job.firstSlice = Clock::now();
+            }
+            if (job.lastFrame != frame_) {
+                job.lastFrame = frame_;
+                ++job.frames;
+            }
+            // Charge what the search did: it stops short of its slice when it finishes.
+            const std::uint64_t before = job.search->expansions();
+            const SearchStatus status = job.search->step(slice);
+            const std::size_t done = static_cast<std::size_t>(job.search->expansions() - before);
+            job.expansions += done;
+            spent += done;
+            if (status != SearchStatus::Running) {
+                finish(job, status);
+            }
+            if (timed && Clock::now() >= deadline) {
+                outOfBudget = true;
+                break;
+            }
+        }
+
+        running_.erase(std::remove_if(running_.begin(), running_.end(),
+                           [](const Job& job) { return job.done; }),
+            running_.end());
+        if (!timed && !capped) {
+            break;
+        }
+        if (!outOfBudget) {
+            admit(timed ? &deadline : nullptr);
+        }
+    }
+    stats_.expansions += spent;
+    return spent;
+}
+
+} // namespace pathcore
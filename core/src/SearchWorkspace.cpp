@@ -0,0 +1,27 @@
+#include "pathcore/SearchWorkspace.h"
+
+#include <cassert>
+
+namespace pathcore {
+
+std::size_t SearchWorkspace::capacityBytes() const {
+    std::size_t bytes = hot_.capacity() * sizeof(SearchBase::HotNode)
+        + open_.capacity() * sizeof(SearchBase::OpenEntry)
+        + dirty_.capacity() * sizeof(std::int32_t)
+        + path_.cells.capacity() * sizeof(CellPos);
+    bytes += snapshot_.state.capacity() * sizeof(NodeState) + snapshot_.parent.capacity() * sizeof(std::int32_t)
+        + snapshot_.fScore.capacity() * sizeof(std::int32_t) + snapshot_.packed.capacity()
+        + snapshot_.gScore.capacity() * sizeof(std::int32_t);
+    return bytes;
+}
+
+void SearchWorkspace::release() {
+    assert(!lent_);
+    hot_ = {};
+    open_ = {};
+    dirty_ = {};
+    snapshot_ = SearchSnapshot{};
+    path_ = SearchPath{};
+}
+
+} // namespace pathcore
@@ -1,9 +1,989 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "pathcore/AStar.h"
+#include "pathcore/AnytimeAStar.h"
+#include "pathcore/BidirectionalDijkstra.h"
+#include "pathcore/Components.h"
+#include "pathcore/Dijkstra.h"
+#include "pathcore/DistanceField.h"
 #include "pathcore/Grid.h"
-#include "pathcore/NodeState.h"
+#include "pathcore/MapIO.h"
+#include "pathcore/Memory.h"
+#include "pathcore/PathCache.h"
+#include "pathcore/PathDatabase.h"
 #include "pathcore/SearchConfig.h"
+#include "pathcore/SearchPath.h"
+#include "pathcore/SearchProfile.h"
+#include "pathcore/SearchRecorder.h"
+#include "pathcore/SearchScheduler.h"
+
+namespace {
+
+std::size_t heapAllocations = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// Walls on about wallPercent of the cells, costs 1..9 elsewhere.
+pathcore::Grid randomGrid(int width, int height, int wallPercent, std::mt19937& rng,
+    pathcore::IndexLayout layout = pathcore::IndexLayout::RowMajor) {
+    pathcore::Grid grid(width, height, 1, layout);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            grid.setCost(pathcore::CellPos{x, y}, 1 + static_cast<int>(rng() % 9));
+            grid.setBlocked(pathcore::CellPos{x, y}, static_cast<int>(rng() % 100) < wallPercent);
+        }
+    }
+    return grid;
+}
+
+pathcore::CellPos randomFreeCell(const pathcore::Grid& grid, std::mt19937& rng) {
+    while (true) {
+        const pathcore::CellPos p{static_cast<int>(rng() % static_cast<unsigned>(grid.width())),
+            static_cast<int>(rng() % static_cast<unsigned>(grid.height()))};
+        if (!grid.isBlocked(p)) {
+            return p;
+        }
+    }
+}
+
+pathcore::SearchStatus runToEnd(pathcore::ISearch& engine) {
+    while (engine.step(256) == pathcore::SearchStatus::Running) {
+    }
+    return engine.status();
+}
+
+// Optimal cost from a fresh Dijkstra, -1 when the goal is unreachable.
+std::int64_t referenceCost(const pathcore::Grid& grid, pathcore::CellPos start, pathcore::CellPos goal,
+    const pathcore::SearchConfig& config) {
+    pathcore::Dijkstra dijkstra;
+    if (!dijkstra.reset(grid, start, goal, config) || runToEnd(dijkstra) != pathcore::SearchStatus::Found) {
+        return -1;
+    }
+    return dijkstra.path().cost;
+}
+
+// Cost of walking `path` from start to goal under the move rules of `config` (no turn
+// penalties), or -1 when it is not a legal walk.
+std::int64_t walkCost(const pathcore::Grid& grid, const pathcore::SearchPath& path, pathcore::CellPos start,
+    pathcore::CellPos goal, const pathcore::SearchConfig& config) {
+    if (path.cells.empty() || path.cells.front() != start || path.cells.back() != goal) {
+        return -1;
+    }
+    std::int64_t cost = 0;
+    for (std::size_t i = 1; i < path.cells.size(); ++i) {
+        const pathcore::CellPos a = path.cells[i - 1];
+        const pathcore::CellPos b = path.cells[i];
+        const int dx = b.x - a.x;
+        const int dy = b.y - a.y;
+        if (!grid.inBounds(b) || grid.isBlocked(b) || dx < -1 || dx > 1 || dy < -1 || dy > 1 || (dx == 0 && dy == 0)) {
+            return -1;
+        }
+        if (dx != 0 && dy != 0) {
+            if (config.neighborMode == pathcore::NeighborMode::Four) {
+                return -1;
+            }
+            if (!config.allowCornerCutting
+                && (grid.isBlocked(pathcore::CellPos{a.x + dx, a.y}) || grid.isBlocked(pathcore::CellPos{a.x, a.y + dy}))) {
+                return -1;
+            }
+        }
+        cost += config.useWeights ? grid.cost(b) : 1;
+    }
+    return cost;
+}
+
+// Moving the goal of a finished Dijkstra must answer like a fresh search, and reopening the
+// goal it closed early must not show up as a reopen in the profile.
+bool checkRetarget() {
+    std::mt19937 rng(36);
+    bool ok = true;
+    for (const pathcore::NeighborMode mode : {pathcore::NeighborMode::Four, pathcore::NeighborMode::Eight}) {
+        const pathcore::Grid grid = randomGrid(40, 30, 25, rng);
+        pathcore::SearchConfig config;
+        config.neighborMode = mode;
+        config.useWeights = true;
+        pathcore::SearchProfile profile;
+        pathcore::Dijkstra dijkstra;
+        dijkstra.setProfile(&profile);
+        const pathcore::CellPos start = randomFreeCell(grid, rng);
+        pathcore::CellPos goal = randomFreeCell(grid, rng);
+        dijkstra.reset(grid, start, goal, config);
+        runToEnd(dijkstra);
+        for (int i = 0; i < 30 && ok; ++i) {
+            goal = randomFreeCell(grid, rng);
+            if (!dijkstra.retarget(goal)) {
+                std::cout << "retarget refused\n";
+                ok = false;
+                break;
+            }
+            const bool found = runToEnd(dijkstra) == pathcore::SearchStatus::Found;
+            const std::int64_t expected = referenceCost(grid, start, goal, config);
+            const std::int64_t cost = found ? dijkstra.path().cost : -1;
+            if (cost != expected || (found && walkCost(grid, dijkstra.path(), start, goal, config) != cost)) {
+                std::cout << "retarget to (" << goal.x << "," << goal.y << ") cost " << cost << ", fresh search " << expected << "\n";
+                ok = false;
+            }
+        }
+        if (profile.total(pathcore::ProfileCounter::Reopens) != 0) {
+            std::cout << "retarget counted " << profile.total(pathcore::ProfileCounter::Reopens) << " reopens\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Labels kept up to date edit by edit must describe the same components as a fresh build().
+// When a split check gives up (needsRebuild) they may only claim too much reachability, and
+// the test rebuilds like AppState does.
+bool checkComponentUpkeep() {
+    std::mt19937 rng(32);
+    bool ok = true;
+    struct Case {
+        pathcore::Connectivity connectivity;
+        int width;
+        int height;
+        int wallPercent;
+        int edits;
+        bool splitWall;
+    };
+    // A wall with one gap splits the map in two halves once the gap closes; on the larger map
+    // both halves outgrow the split flood's budget, so that split is given up on.
+    const Case cases[] = {{pathcore::Connectivity::Four, 48, 40, 35, 3000, true},
+                          {pathcore::Connectivity::Eight, 48, 40, 35, 3000, false},
+                          {pathcore::Connectivity::Four, 128, 96, 15, 400, true},
+                          {pathcore::Connectivity::Eight, 128, 96, 15, 400, true}};
+    for (const Case& c : cases) {
+        const pathcore::Connectivity connectivity = c.connectivity;
+        pathcore::Grid grid = randomGrid(c.width, c.height, c.wallPercent, rng);
+        const pathcore::CellPos gap{c.width / 2, c.height / 2};
+        if (c.splitWall) {
+            for (int y = 0; y < c.height; ++y) {
+                grid.setBlocked({gap.x, y}, y != gap.y);
+            }
+            grid.setBlocked({gap.x - 1, gap.y}, false);
+            grid.setBlocked({gap.x + 1, gap.y}, false);
+        }
+        pathcore::ComponentLabels labels;
+        labels.build(grid, connectivity, 1);
+        int splitsGivenUp = 0;
+        for (int edit = 0; edit < c.edits && ok; ++edit) {
+            const pathcore::CellPos p = c.splitWall && edit == 0
+                ? gap
+                : pathcore::CellPos{static_cast<int>(rng() % c.width), static_cast<int>(rng() % c.height)};
+            const bool blocked = !grid.isBlocked(p);
+            grid.setBlocked(p, blocked);
+            if (blocked) {
+                labels.onCellBlocked(grid, p);
+            } else {
+                labels.onCellOpened(grid, p);
+            }
+
+            pathcore::ComponentLabels fresh;
+            fresh.build(grid, connectivity, 1);
+            const bool exact = !labels.needsRebuild();
+            if (!labels.matches(grid, connectivity) || (exact && labels.componentCount() != fresh.componentCount())) {
+                std::cout << "labels out of date after edit " << edit << "\n";
+                ok = false;
+                break;
+            }
+            // Same partition: equal labels on one side exactly when equal on the other.
+            std::map<std::int32_t, std::int32_t> toFresh;
+            std::map<std::int32_t, std::int32_t> toKept;
+            for (int y = 0; y < c.height && ok; ++y) {
+                for (int x = 0; x < c.width; ++x) {
+                    const pathcore::CellPos cell{x, y};
+                    const std::int32_t kept = labels.label(cell);
+                    const std::int32_t built = fresh.label(cell);
+                    if ((kept == pathcore::ComponentLabels::kBlocked) != (built == pathcore::ComponentLabels::kBlocked)) {
+                        ok = false;
+                        break;
+                    }
+                    if (kept == pathcore::ComponentLabels::kBlocked) {
+                        continue;
+                    }
+                    const auto f = toFresh.emplace(kept, built).first;
+                    const auto k = toKept.emplace(built, kept).first;
+                    // Stale labels may merge fresh components but never split one.
+                    if (k->second != kept || (exact && f->second != built)) {
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+            for (int i = 0; i < 50 && ok; ++i) {
+                const pathcore::CellPos a = randomFreeCell(grid, rng);
+                const pathcore::CellPos b = randomFreeCell(grid, rng);
+                const bool reachable = fresh.isReachable(a, b);
+                const bool claimed = labels.isReachable(a, b);
+                ok = exact ? claimed == reachable : (claimed || !reachable);
+            }
+            if (!ok) {
+                std::cout << "labels disagree with a rebuild after edit " << edit << "\n";
+                break;
+            }
+            if (!exact) {
+                ++splitsGivenUp;
+                labels.build(grid, connectivity, 1);
+            }
+        }
+        std::cout << "Component upkeep connectivity=" << (connectivity == pathcore::Connectivity::Four ? 4 : 8)
+                  << " size=" << c.width << "x" << c.height << " rebuilds=" << splitsGivenUp << "\n";
+        if (!ok) {
+            break;
+        }
+    }
+    return ok;
+}
+
+// A database built offline must answer with Dijkstra's costs, stop matching once the grid
+// changes, and open() must refuse truncated or corrupted files instead of trusting them.
+bool checkPathDatabase() {
+    std::mt19937 rng(34);
+    const std::string filePath = (std::filesystem::temp_directory_path() / "core_smoke.pathdb").string();
+    const std::string badPath = (std::filesystem::temp_directory_path() / "core_smoke_bad.pathdb").string();
+    pathcore::Grid grid = randomGrid(24, 18, 25, rng);
+    const std::size_t cells = 24 * 18;
+    bool ok = true;
+    std::vector<char> good;
+    for (int variant = 0; variant < 3 && ok; ++variant) {
+        pathcore::SearchConfig config;
+        config.useWeights = true;
+        config.neighborMode = variant == 0 ? pathcore::NeighborMode::Four : pathcore::NeighborMode::Eight;
+        config.allowCornerCutting = variant == 2;
+        pathcore::PathDatabaseError err;
+        pathcore::PathDatabase db;
+        if (!pathcore::buildPathDatabase(grid, config, filePath, 2, &err) || !db.open(filePath, &err)) {
+            std::cout << "path database: " << err.message << "\n";
+            return false;
+        }
+        for (int q = 0; q < 200 && ok; ++q) {
+            const pathcore::CellPos start = randomFreeCell(grid, rng);
+            const pathcore::CellPos goal = randomFreeCell(grid, rng);
+            const bool found = db.reset(grid, start, goal, config) && runToEnd(db) == pathcore::SearchStatus::Found;
+            const std::int64_t cost = found ? db.path().cost : -1;
+            if (cost != referenceCost(grid, start, goal, config)
+                || (found && walkCost(grid, db.path(), start, goal, config) != cost)) {
+                std::cout << "path database answered " << cost << " from (" << start.x << "," << start.y << ") to ("
+                          << goal.x << "," << goal.y << ")\n";
+                ok = false;
+            }
+        }
+        pathcore::SearchConfig other = config;
+        other.allowCornerCutting = !config.allowCornerCutting;
+        if (!db.matches(grid, config) || (variant != 0 && db.matches(grid, other))) {
+            std::cout << "path database matches the wrong move rules\n";
+            ok = false;
+        }
+        if (variant == 2) {
+            std::ifstream in(filePath, std::ios::binary);
+            good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+    }
+    pathcore::PathDatabase db;
+    if (ok && db.open(filePath)) {
+        pathcore::Grid edited = grid;
+        const pathcore::CellPos p = randomFreeCell(edited, rng);
+        edited.setCost(p, edited.cost(p) % 9 + 1);
+        pathcore::SearchConfig config;
+        config.useWeights = true;
+        config.neighborMode = pathcore::NeighborMode::Eight;
+        config.allowCornerCutting = true;
+        if (!db.matches(grid, config) || db.matches(edited, config) || db.reset(edited, p, p, config)) {
+            std::cout << "path database still matches an edited grid\n";
+            ok = false;
+        }
+    }
+    db.close();
+
+    // Layout from PathDatabase.cpp: a 40-byte header, then (cells + 1) uint64 row offsets, then
+    // uint32 runs whose index is in the upper 28 bits.
+    const std::size_t headerBytes = 40;
+    const std::size_t runsAt = headerBytes + (cells + 1) * sizeof(std::uint64_t);
+    auto rowStart = [&good](std::size_t row) {
+        std::uint64_t v = 0;
+        std::memcpy(&v, &good[headerBytes + row * sizeof(std::uint64_t)], sizeof(v));
+        return v;
+    };
+    std::uint64_t runCount = 0;
+    std::memcpy(&runCount, &good[headerBytes - sizeof(runCount)], sizeof(runCount));
+    std::size_t firstNonEmpty = 0;
+    while (rowStart(firstNonEmpty + 1) == rowStart(firstNonEmpty)) {
+        ++firstNonEmpty;
+    }
+    struct Corruption {
+        const char* name;
+        std::size_t keepBytes;
+        std::size_t at;
+        std::uint64_t value;
+        std::size_t width;
+    };
+    const Corruption corruptions[] = {
+        {"empty file", 0, 0, 0, 0},
+        {"short header", headerBytes / 2, 0, 0, 0},
+        {"truncated row table", headerBytes + cells * sizeof(std::uint64_t) / 2, 0, 0, 0},
+        {"truncated runs", good.size() - sizeof(std::uint32_t), 0, 0, 0},
+        {"bad magic", good.size(), 0, 0x58, 1},
+        {"bad version", good.size(), 8, 99, 4},
+        {"run count past the file", good.size(), headerBytes - 8, good.size(), 8},
+        {"rows out of order", good.size(), headerBytes + sizeof(std::uint64_t), runCount + 5, 8},
+        {"row table past the runs", good.size(), headerBytes + cells * sizeof(std::uint64_t), runCount + 1, 8},
+        {"row not starting at target 0", good.size(), runsAt + rowStart(firstNonEmpty) * sizeof(std::uint32_t),
+            (1u << 4) | 1u, 4},
+    };
+    for (const Corruption& c : corruptions) {
+        if (!ok) {
+            break;
+        }
+        std::vector<char> bytes(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(c.keepBytes));
+        if (c.width != 0) {
+            std::memcpy(&bytes[c.at], &c.value, c.width);
+        }
+        {
+            std::ofstream out(badPath, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        pathcore::PathDatabaseError err;
+        if (db.open(badPath, &err) || db.isOpen() || err.message.empty()) {
+            std::cout << "path database accepted a file with " << c.name << "\n";
+            ok = false;
+        }
+    }
+    std::error_code ignored;
+    std::filesystem::remove(filePath, ignored);
+    std::filesystem::remove(badPath, ignored);
+    return ok;
+}
+
+// Repairing a distance field after wall and cost edits must give the distances of a fresh
+// build, and its flow field must still walk to a goal at exactly that cost.
+bool checkDistanceFieldRepair() {
+    std::mt19937 rng(35);
+    bool ok = true;
+    for (int variant = 0; variant < 4 && ok; ++variant) {
+        pathcore::SearchConfig config;
+        config.useWeights = variant != 3;
+        config.neighborMode = variant == 0 ? pathcore::NeighborMode::Four : pathcore::NeighborMode::Eight;
+        config.allowCornerCutting = variant == 2;
+        pathcore::Grid grid = randomGrid(40, 30, 20, rng);
+        std::vector<pathcore::CellPos> goals;
+        for (int i = 0; i < 3; ++i) {
+            goals.push_back(randomFreeCell(grid, rng));
+        }
+        auto isGoal = [&goals](pathcore::CellPos p) {
+            for (const pathcore::CellPos& g : goals) {
+                if (g == p) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        pathcore::DistanceField field;
+        field.build(grid, config, goals);
+        for (int batch = 0; batch < 300 && ok; ++batch) {
+            std::vector<pathcore::CellPos> changed;
+            const int edits = 1 + static_cast<int>(rng() % 5);
+            while (static_cast<int>(changed.size()) < edits) {
+                const pathcore::CellPos p{static_cast<int>(rng() % 40), static_cast<int>(rng() % 30)};
+                if (isGoal(p)) {
+                    continue;
+                }
+                if (rng() % 2 == 0) {
+                    grid.setBlocked(p, !grid.isBlocked(p));
+                } else {
+                    grid.setCost(p, 1 + static_cast<int>(rng() % 9));
+                }
+                changed.push_back(p);
+            }
+            if (!field.update(grid, changed) || !field.matches(grid, config)) {
+                std::cout << "distance field update refused\n";
+                ok = false;
+                break;
+            }
+            pathcore::DistanceField fresh;
+            fresh.build(grid, config, goals);
+            for (int y = 0; y < 30 && ok; ++y) {
+                for (int x = 0; x < 40 && ok; ++x) {
+                    const pathcore::CellPos p{x, y};
+                    const std::int32_t d = field.distance(p);
+                    if (d != fresh.distance(p)) {
+                        std::cout << "distance field repaired (" << x << "," << y << ") to " << d << " instead of "
+                                  << fresh.distance(p) << "\n";
+                        ok = false;
+                    } else if (!grid.isBlocked(p) && d != pathcore::SearchSnapshot::kInfScore) {
+                        const std::vector<pathcore::CellPos> cells = field.pathFrom(p);
+                        pathcore::SearchPath walk;
+                        walk.cells.assign(cells.begin(), cells.end());
+                        if (cells.empty() || !isGoal(cells.back())
+                            || walkCost(grid, walk, p, cells.back(), config) != d) {
+                            std::cout << "distance field flow from (" << x << "," << y << ") does not match its distance\n";
+                            ok = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+// Cached answers, whole or sliced out of a longer path in either direction, must cost what a
+// fresh Dijkstra finds; an edit must hide older entries, and the byte cap must evict the least
+// recently used entry first.
+bool checkPathCache() {
+    std::mt19937 rng(47);
+    pathcore::SearchConfig config;
+    config.useWeights = true;
+    config.neighborMode = pathcore::NeighborMode::Eight;
+    pathcore::Grid grid = randomGrid(40, 30, 20, rng);
+    pathcore::PathCache cache;
+    bool ok = true;
+    auto answersLikeDijkstra = [&](pathcore::CellPos start, pathcore::CellPos goal) {
+        pathcore::SearchPath cached;
+        return cache.lookup(grid, start, goal, config, &cached)
+            && cached.cost == referenceCost(grid, start, goal, config)
+            && walkCost(grid, cached, start, goal, config) == cached.cost;
+    };
+    for (int i = 0; i < 100 && ok; ++i) {
+        const pathcore::CellPos start = randomFreeCell(grid, rng);
+        const pathcore::CellPos goal = randomFreeCell(grid, rng);
+        pathcore::Dijkstra dijkstra;
+        if (!dijkstra.reset(grid, start, goal, config) || runToEnd(dijkstra) != pathcore::SearchStatus::Found) {
+            continue;
+        }
+        const pathcore::SearchPath& path = dijkstra.path();
+        cache.insert(grid, start, goal, config, path);
+        const std::size_t n = path.cells.size();
+        const std::size_t a = rng() % n;
+        const std::size_t b = rng() % n;
+        if (!answersLikeDijkstra(start, goal) || !answersLikeDijkstra(path.cells[a], path.cells[b])
+            || !answersLikeDijkstra(path.cells[b], path.cells[a])) {
+            std::cout << "path cache answer differs from Dijkstra\n";
+            ok = false;
+        }
+    }
+    const pathcore::PathCacheStats warm = cache.stats();
+    if (ok && (warm.hits == 0 || warm.subPathHits == 0 || warm.hits + warm.subPathHits != warm.lookups)) {
+        std::cout << "path cache hits=" << warm.hits << " subPathHits=" << warm.subPathHits << " lookups=" << warm.lookups
+                  << "\n";
+        ok = false;
+    }
+
+    // Through a scheduler: the second identical request is answered without an engine.
+    if (ok) {
+        pathcore::SearchScheduler scheduler(grid, [] { return std::make_unique<pathcore::Dijkstra>(); });
+        scheduler.setPathCache(&cache);
+        const pathcore::CellPos start = randomFreeCell(grid, rng);
+        const pathcore::CellPos goal = randomFreeCell(grid, rng);
+        std::vector<pathcore::SearchResult> results;
+        for (int round = 0; round < 2; ++round) {
+            scheduler.submit(pathcore::SearchRequest{start, goal, config, 0});
+            while (scheduler.waitingCount() + scheduler.inFlightCount() > 0) {
+                scheduler.runFrame(pathcore::FrameBudget{});
+            }
+            for (pathcore::SearchResult& r : scheduler.takeResults()) {
+                results.push_back(std::move(r));
+            }
+        }
+        const std::int64_t expected = referenceCost(grid, start, goal, config);
+        if (results.size() != 2 || scheduler.stats().cacheHits < 1 || results[1].expansions != 0
+            || (expected >= 0 && (results[0].path.cost != expected || results[1].path.cost != expected))) {
+            std::cout << "scheduler did not reuse the cached path\n";
+            ok = false;
+        }
+    }
+
+    const pathcore::CellPos edited = randomFreeCell(grid, rng);
+    pathcore::SearchPath anyPath;
+    grid.setCost(edited, grid.cost(edited) % 9 + 1);
+    for (int i = 0; i < 50 && ok; ++i) {
+        if (cache.lookup(grid, randomFreeCell(grid, rng), randomFreeCell(grid, rng), config, &anyPath)) {
+            std::cout << "path cache answered from before an edit\n";
+            ok = false;
+        }
+    }
+    cache.dropOtherVersions(grid);
+    if (ok && (cache.stats().entries != 0 || cache.stats().bytes != 0)) {
+        std::cout << "path cache kept entries of an older grid\n";
+        ok = false;
+    }
+
+    // On an open grid every path from (0, y) to (9, y) has 10 cells, so entries are the same size.
+    const pathcore::Grid open(10, 8);
+    pathcore::SearchConfig fourWay;
+    pathcore::PathCache sized(pathcore::PathCacheOptions{~std::size_t{0}, false});
+    auto insertRow = [&](pathcore::PathCache& target, int y) {
+        pathcore::Dijkstra dijkstra;
+        dijkstra.reset(open, pathcore::CellPos{0, y}, pathcore::CellPos{9, y}, fourWay);
+        runToEnd(dijkstra);
+        target.insert(open, pathcore::CellPos{0, y}, pathcore::CellPos{9, y}, fourWay, dijkstra.path());
+    };
+    insertRow(sized, 0);
+    pathcore::PathCache lru(pathcore::PathCacheOptions{sized.stats().bytes * 3, false});
+    auto has = [&](int y) { return lru.lookup(open, pathcore::CellPos{0, y}, pathcore::CellPos{9, y}, fourWay, nullptr); };
+    insertRow(lru, 0);
+    insertRow(lru, 1);
+    insertRow(lru, 2);
+    // Touching row 0 leaves row 1 as the least recently used.
+    const bool touched = has(0);
+    insertRow(lru, 3);
+    insertRow(lru, 4);
+    const pathcore::PathCacheStats capped = lru.stats();
+    if (ok && (!touched || capped.entries != 3 || capped.evictions != 2 || capped.bytes > sized.stats().bytes * 3
+                  || !has(0) || has(1) || has(2) || !has(3) || !has(4))) {
+        std::cout << "path cache evicted the wrong entries\n";
+        ok = false;
+    }
+    return ok;
+}
+
+// Bidirectional Dijkstra stops once the frontiers meet, so check its costs against a one-sided
+// Dijkstra on weighted mazes for every move rule, reusing one engine like the app does.
+bool checkBidirectionalOptimal() {
+    std::mt19937 rng(40);
+    bool ok = true;
+    pathcore::BidirectionalDijkstra bidirectional;
+    for (int variant = 0; variant < 4 && ok; ++variant) {
+        pathcore::SearchConfig config;
+        config.useWeights = variant != 3;
+        config.neighborMode = variant == 0 ? pathcore::NeighborMode::Four : pathcore::NeighborMode::Eight;
+        config.allowCornerCutting = variant == 2;
+        for (int map = 0; map < 4 && ok; ++map) {
+            const pathcore::Grid grid = randomGrid(48, 36, 15 + 5 * map, rng);
+            for (int q = 0; q < 60 && ok; ++q) {
+                const pathcore::CellPos start = randomFreeCell(grid, rng);
+                const pathcore::CellPos goal = randomFreeCell(grid, rng);
+                const bool found = bidirectional.reset(grid, start, goal, config)
+                    && runToEnd(bidirectional) == pathcore::SearchStatus::Found;
+                const std::int64_t cost = found ? bidirectional.path().cost : -1;
+                if (cost != referenceCost(grid, start, goal, config)
+                    || (found && walkCost(grid, bidirectional.path(), start, goal, config) != cost)) {
+                    std::cout << "bidirectional variant " << variant << " found " << cost << " instead of "
+                              << referenceCost(grid, start, goal, config) << "\n";
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+// Every path ARA* and focal search publish while running must be a legal walk within its
+// bound of the optimal cost, no worse than the one before, and the final path must be optimal.
+bool checkAnytimeBounds() {
+    std::mt19937 rng(38);
+    bool ok = true;
+    for (const pathcore::AnytimeVariant variant : {pathcore::AnytimeVariant::Ara, pathcore::AnytimeVariant::Focal}) {
+        pathcore::AnytimeOptions options;
+        options.variant = variant;
+        options.initialWeight = 3.0;
+        options.weightStep = 0.5;
+        pathcore::AnytimeAStar anytime(options);
+        int improvements = 0;
+        for (int mode = 0; mode < 4 && ok; ++mode) {
+            pathcore::SearchConfig config;
+            config.useWeights = mode < 2;
+            config.neighborMode = mode % 2 == 0 ? pathcore::NeighborMode::Four : pathcore::NeighborMode::Eight;
+            const pathcore::Grid grid = randomGrid(48, 36, 20, rng);
+            for (int q = 0; q < 25 && ok; ++q) {
+                const pathcore::CellPos start = randomFreeCell(grid, rng);
+                const pathcore::CellPos goal = randomFreeCell(grid, rng);
+                const std::int64_t optimal = referenceCost(grid, start, goal, config);
+                if (!anytime.reset(grid, start, goal, config)) {
+                    ok = false;
+                    break;
+                }
+                int seen = 0;
+                std::int64_t previous = -1;
+                pathcore::SearchStatus status = pathcore::SearchStatus::Running;
+                while (ok && (status == pathcore::SearchStatus::Running || seen != anytime.solutionCount())) {
+                    if (seen != anytime.solutionCount()) {
+                        seen = anytime.solutionCount();
+                        const pathcore::SearchPath& path = anytime.path();
+                        if (optimal < 0 || path.bound < 1.0 || path.cost > path.bound * static_cast<double>(optimal) + 1e-9
+                            || walkCost(grid, path, start, goal, config) != path.cost
+                            || (previous >= 0 && path.cost > previous)) {
+                            std::cout << "anytime path " << seen << " costs " << path.cost << " with bound " << path.bound
+                                      << ", optimal " << optimal << "\n";
+                            ok = false;
+                        }
+                        improvements += previous >= 0 && path.cost < previous ? 1 : 0;
+                        previous = path.cost;
+                    }
+                    if (status == pathcore::SearchStatus::Running) {
+                        status = anytime.step(16);
+                    }
+                }
+                const bool found = status == pathcore::SearchStatus::Found;
+                if (ok && ((found ? anytime.path().cost : -1) != optimal || (found && anytime.path().bound != 1.0))) {
+                    std::cout << "anytime search ended at " << (found ? anytime.path().cost : -1) << " instead of "
+                              << optimal << "\n";
+                    ok = false;
+                }
+            }
+        }
+        // Starting at weight 3 some first paths must be improved on, or the bounds were never tested.
+        if (ok && improvements == 0) {
+            std::cout << "anytime search never improved a path\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool sameSearchState(const pathcore::SearchSnapshot& a, const pathcore::SearchSnapshot& b) {
+    if (a.width != b.width || a.height != b.height) {
+        return false;
+    }
+    for (int y = 0; y < a.height; ++y) {
+        for (int x = 0; x < a.width; ++x) {
+            const std::int32_t i = a.indexOf(pathcore::CellPos{x, y});
+            const std::int32_t j = b.indexOf(pathcore::CellPos{x, y});
+            if (a.stateAt(i) != b.stateAt(j)) {
+                return false;
+            }
+            if (a.stateAt(i) != pathcore::NodeState::Unseen && (a.gAt(i) != b.gAt(j) || a.parentAt(i) != b.parentAt(j))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// reconstruct(N) must give back the live search as it was after N state changes, across
+// keyframe boundaries and after the oldest intervals were dropped for space.
+bool checkRecorderReplay() {
+    std::mt19937 rng(49);
+    bool ok = true;
+    for (int variant = 0; variant < 2 && ok; ++variant) {
+        const pathcore::Grid grid =
+            randomGrid(30, 22, 20, rng, variant == 0 ? pathcore::IndexLayout::RowMajor : pathcore::IndexLayout::Tiled);
+        pathcore::SearchConfig config;
+        config.useWeights = true;
+        config.neighborMode = pathcore::NeighborMode::Eight;
+        config.snapshotLayout = variant == 0 ? pathcore::SnapshotLayout::Full : pathcore::SnapshotLayout::Compact;
+        const pathcore::CellPos start = randomFreeCell(grid, rng);
+        const pathcore::CellPos goal = randomFreeCell(grid, rng);
+        pathcore::Dijkstra dijkstra;
+        pathcore::AStar astar;
+        pathcore::BidirectionalDijkstra bidirectional;
+        for (pathcore::ISearch* engine : {static_cast<pathcore::ISearch*>(&dijkstra), static_cast<pathcore::ISearch*>(&astar),
+                 static_cast<pathcore::ISearch*>(&bidirectional)}) {
+            // Intervals are at most half of maxDeltas, so the small caps keep a few keyframes
+            // and drop the rest.
+            for (const std::size_t maxDeltas : {std::size_t{300}, std::size_t{1000}, std::size_t{1} << 20}) {
+                pathcore::SearchRecorder recorder(pathcore::RecorderOptions{maxDeltas, 1});
+                engine->setRecorder(&recorder);
+                engine->reset(grid, start, goal, config);
+                std::vector<std::pair<std::uint64_t, pathcore::SearchSnapshot>> seen;
+                seen.emplace_back(recorder.stepCount(), engine->snapshot());
+                while (engine->step(1) == pathcore::SearchStatus::Running) {
+                    seen.emplace_back(recorder.stepCount(), engine->snapshot());
+                }
+                seen.emplace_back(recorder.stepCount(), engine->snapshot());
+                engine->setRecorder(nullptr);
+
+                // On this grid the interval is maxDeltas / 2. The oldest intervals are dropped as
+                // a new one starts, the first time when the fourth one does.
+                const std::uint64_t interval = maxDeltas / 2;
+                const bool dropped = recorder.firstStep() > 0;
+                const std::uint64_t kept = recorder.stepCount() - recorder.firstStep();
+                pathcore::SearchSnapshot rebuilt;
+                if (dropped != (recorder.stepCount() > 3 * interval) || kept > maxDeltas + interval
+                    || recorder.reconstruct(recorder.stepCount() + 1, &rebuilt)
+                    || (dropped && recorder.reconstruct(recorder.firstStep() - 1, &rebuilt))
+                    || !recorder.reconstruct(recorder.firstStep(), &rebuilt)) {
+                    std::cout << "recorder kept steps " << recorder.firstStep() << ".." << recorder.stepCount()
+                              << " with maxDeltas " << maxDeltas << "\n";
+                    ok = false;
+                }
+                for (const auto& [step, live] : seen) {
+                    if (!ok) {
+                        break;
+                    }
+                    if (step < recorder.firstStep()) {
+                        continue;
+                    }
+                    if (!recorder.reconstruct(step, &rebuilt) || !sameSearchState(live, rebuilt)) {
+                        std::cout << "recorder step " << step << " differs from the live search\n";
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+// The incrementally kept content hash must equal that of a grid filled from scratch, whatever
+// the layout, survive a save/load round trip, and not leak between copies that share chunks.
+bool checkContentHash() {
+    std::mt19937 rng(46);
+    const int width = 37;
+    const int height = 29;
+    pathcore::Grid rowMajor(width, height);
+    pathcore::Grid tiled(width, height, 1, pathcore::IndexLayout::Tiled);
+    rowMajor.contentHash();
+    tiled.contentHash();
+    auto filledFrom = [&](const pathcore::Grid& source, pathcore::IndexLayout layout) {
+        pathcore::Grid fresh(width, height, 1, layout);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                fresh.setCost(pathcore::CellPos{x, y}, source.cost(pathcore::CellPos{x, y}));
+                fresh.setBlocked(pathcore::CellPos{x, y}, source.isBlocked(pathcore::CellPos{x, y}));
+            }
+        }
+        return fresh;
+    };
+    bool ok = true;
+    for (int batch = 0; batch < 60 && ok; ++batch) {
+        const int edits = 1 + static_cast<int>(rng() % 8);
+        for (int i = 0; i < edits; ++i) {
+            const pathcore::CellPos p{static_cast<int>(rng() % width), static_cast<int>(rng() % height)};
+            const int kind = static_cast<int>(rng() % 8);
+            if (kind == 0) {
+                // Rectangles cross tile borders and get clipped at the grid's edges.
+                const pathcore::CellPos origin{p.x - 4, p.y - 1};
+                const int w = 1 + static_cast<int>(rng() % 12);
+                const int h = 1 + static_cast<int>(rng() % 3);
+                const pathcore::Cell value{rng() % 2 == 0, 1 + static_cast<int>(rng() % 9)};
+                rowMajor.fillRect(origin, w, h, value);
+                tiled.fillRect(origin, w, h, value);
+            } else if (kind == 1) {
+                std::vector<pathcore::Cell> pattern(10);
+                for (pathcore::Cell& c : pattern) {
+                    c = pathcore::Cell{rng() % 4 == 0, 1 + static_cast<int>(rng() % 9)};
+                }
+                rowMajor.stamp(p, 5, pattern);
+                tiled.stamp(p, 5, pattern);
+            } else if (kind < 4) {
+                const bool blocked = !rowMajor.isBlocked(p);
+                rowMajor.setBlocked(p, blocked);
+                tiled.setBlocked(p, blocked);
+            } else {
+                const int cost = 1 + static_cast<int>(rng() % 9);
+                rowMajor.setCost(p, cost);
+                tiled.setCost(p, cost);
+            }
+        }
+        const std::uint64_t hash = rowMajor.contentHash();
+        if (hash != tiled.contentHash() || hash != filledFrom(rowMajor, pathcore::IndexLayout::RowMajor).contentHash()
+            || hash != filledFrom(rowMajor, pathcore::IndexLayout::Tiled).contentHash()) {
+            std::cout << "content hash differs from a fresh grid after batch " << batch << "\n";
+            ok = false;
+        }
+
+        // An edit on a copy that still shares chunks must not show up in the original.
+        pathcore::Grid copy = rowMajor;
+        const pathcore::CellPos p = randomFreeCell(copy, rng);
+        copy.setCost(p, copy.cost(p) % 9 + 1);
+        if (ok && (copy.contentHash() == hash || rowMajor.contentHash() != hash
+                      || copy.contentHash() != filledFrom(copy, pathcore::IndexLayout::Tiled).contentHash())) {
+            std::cout << "content hash leaked between copies\n";
+            ok = false;
+        }
+    }
+
+    const std::string filePath = (std::filesystem::temp_directory_path() / "core_smoke_hash.map").string();
+    const pathcore::CellPos start = randomFreeCell(rowMajor, rng);
+    const pathcore::CellPos goal = randomFreeCell(rowMajor, rng);
+    if (ok && !pathcore::saveMapToFile(tiled, start, goal, filePath)) {
+        std::cout << "could not save " << filePath << "\n";
+        ok = false;
+    }
+    for (const pathcore::IndexLayout layout : {pathcore::IndexLayout::RowMajor, pathcore::IndexLayout::Tiled}) {
+        if (!ok) {
+            break;
+        }
+        const std::optional<pathcore::LoadedMap> loaded = pathcore::loadMapFromFile(filePath, nullptr, layout);
+        if (!loaded || loaded->grid.contentHash() != rowMajor.contentHash()) {
+            std::cout << "content hash changed through save and load\n";
+            ok = false;
+        }
+    }
+    std::error_code ignored;
+    std::filesystem::remove(filePath, ignored);
+    return ok;
+}
+
+// Under an expansion budget every frame must stay within it, every request must complete with
+// Dijkstra's answer, and the expansions charged to results must add up to the stats. Cancelling
+// long searches after a few frames shows each one's share: equal for equal priorities, larger
+// for a higher priority, and never zero for the lower one.
+bool checkSchedulerBudgets() {
+    std::mt19937 rng(41);
+    bool ok = true;
+    const pathcore::Grid grid = randomGrid(64, 48, 20, rng);
+    pathcore::SearchConfig config;
+    config.useWeights = true;
+    config.neighborMode = pathcore::NeighborMode::Eight;
+    auto factory = [] { return std::make_unique<pathcore::Dijkstra>(); };
+    {
+        pathcore::SearchScheduler scheduler(grid, factory, pathcore::SchedulerOptions{8, 32, 4});
+        std::map<std::uint64_t, std::int64_t> expected;
+        for (int i = 0; i < 40; ++i) {
+            const pathcore::CellPos start = randomFreeCell(grid, rng);
+            const pathcore::CellPos goal = randomFreeCell(grid, rng);
+            const std::uint64_t id =
+                scheduler.submit(pathcore::SearchRequest{start, goal, config, static_cast<int>(rng() % 4)});
+            expected[id] = referenceCost(grid, start, goal, config);
+        }
+        std::size_t spent = 0;
+        std::uint64_t charged = 0;
+        std::size_t completed = 0;
+        for (int frame = 0; frame < 10000 && ok && scheduler.waitingCount() + scheduler.inFlightCount() > 0; ++frame) {
+            const std::size_t used = scheduler.runFrame(pathcore::FrameBudget{500, {}});
+            spent += used;
+            if (used > 500) {
+                std::cout << "scheduler frame spent " << used << " of 500\n";
+                ok = false;
+            }
+            for (const pathcore::SearchResult& r : scheduler.takeResults()) {
+                const bool found = r.status == pathcore::SearchStatus::Found;
+                if ((found ? r.path.cost : -1) != expected[r.id]
+                    || (!found && r.status != pathcore::SearchStatus::NoPath)) {
+                    std::cout << "scheduler request " << r.id << " ended with " << (found ? r.path.cost : -1) << "\n";
+                    ok = false;
+                }
+                charged += r.expansions;
+                ++completed;
+            }
+        }
+        if (ok && (completed != 40 || scheduler.stats().completed != 40 || charged != scheduler.stats().expansions
+                      || spent != scheduler.stats().expansions)) {
+            std::cout << "scheduler completed " << completed << ", charged " << charged << ", spent " << spent
+                      << ", counted " << scheduler.stats().expansions << "\n";
+            ok = false;
+        }
+    }
+
+    // Corner to corner on an open map, so no search finishes within the frames below.
+    const pathcore::Grid open(200, 200);
+    auto shares = [&](const std::vector<int>& priorities, int frames) {
+        pathcore::SearchScheduler scheduler(open, factory, pathcore::SchedulerOptions{8, 32, 4});
+        std::vector<std::uint64_t> ids;
+        for (std::size_t i = 0; i < priorities.size(); ++i) {
+            const int y = static_cast<int>(i) * 2;
+            ids.push_back(scheduler.submit(
+                pathcore::SearchRequest{pathcore::CellPos{0, y}, pathcore::CellPos{199, 199 - y}, config, priorities[i]}));
+        }
+        for (int frame = 0; frame < frames; ++frame) {
+            scheduler.runFrame(pathcore::FrameBudget{4000, {}});
+        }
+        for (const std::uint64_t id : ids) {
+            scheduler.cancel(id);
+        }
+        std::vector<std::size_t> out;
+        for (const pathcore::SearchResult& r : scheduler.takeResults()) {
+            out.push_back(r.status == pathcore::SearchStatus::Cancelled ? r.expansions : 0);
+        }
+        return out;
+    };
+    if (ok) {
+        const std::vector<std::size_t> equal = shares({1, 1, 1, 1}, 3);
+        for (const std::size_t e : equal) {
+            if (equal.size() != 4 || e == 0 || e + 32 < equal.front() || e > equal.front() + 32) {
+                std::cout << "scheduler gave equal priorities " << e << " vs " << equal.front() << "\n";
+                ok = false;
+                break;
+            }
+        }
+    }
+    if (ok) {
+        const std::vector<std::size_t> ranked = shares({0, 3}, 3);
+        if (ranked.size() != 2 || ranked[0] == 0 || ranked[1] <= 2 * ranked[0]) {
+            std::cout << "scheduler gave priorities 0 and 3 " << (ranked.empty() ? 0 : ranked[0]) << " and "
+                      << (ranked.size() < 2 ? 0 : ranked[1]) << " expansions\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Once every query has run once, repeating them must not reach the engines' upstream resource
+// nor the global heap.
+bool checkWarmQueries() {
+    pathcore::Grid grid(64, 48);
+    for (int x = 4; x < 60; ++x) {
+        grid.setBlocked(pathcore::CellPos{x, 24}, true);
+    }
+    pathcore::SearchConfig config;
+    config.neighborMode = pathcore::NeighborMode::Eight;
+    const pathcore::CellPos queries[][2] = {
+        {pathcore::CellPos{0, 0}, pathcore::CellPos{63, 47}},
+        {pathcore::CellPos{10, 40}, pathcore::CellPos{50, 5}},
+        {pathcore::CellPos{63, 0}, pathcore::CellPos{0, 47}},
+    };
+
+    pathcore::CountingResource counting;
+    pathcore::Dijkstra dijkstra(&counting);
+    pathcore::AStar astar(&counting);
+    pathcore::AnytimeAStar anytime(pathcore::AnytimeOptions{}, &counting);
+    pathcore::BidirectionalDijkstra bidirectional(&counting);
+    const struct {
+        const char* name;
+        pathcore::ISearch* engine;
+    } engines[] = {
+        {"Dijkstra", &dijkstra},
+        {"AStar", &astar},
+        {"AnytimeAStar", &anytime},
+        {"BidirectionalDijkstra", &bidirectional},
+    };
+
+    bool ok = true;
+    for (const auto& entry : engines) {
+        auto runQueries = [&]() {
+            for (const auto& query : queries) {
+                entry.engine->reset(grid, query[0], query[1], config);
+                while (entry.engine->step(256) == pathcore::SearchStatus::Running) {
+                }
+            }
+        };
+        runQueries();
+        runQueries();
+        counting.resetCounters();
+        const std::size_t heapBefore = heapAllocations;
+        runQueries();
+        const std::size_t heap = heapAllocations - heapBefore;
+        std::cout << entry.name << " warm queries: upstream allocations=" << counting.allocations()
+                  << " heap allocations=" << heap << "\n";
+        ok = ok && counting.allocations() == 0 && heap == 0;
+    }
+    return ok;
+}
+
+} // namespace
 
 int main() {
     pathcore::Grid grid(10, 10);
@@ -36,12 +1016,7 @@ int main() {
         ++steps;
     }
 
-    std::size_t pathCount = 0;
-    for (pathcore::NodeState state : astar.snapshot().state) {
-        if (state == pathcore::NodeState::Path) {
-            ++pathCount;
-        }
-    }
+    const pathcore::SearchPath& path = astar.path();
 
     const char* statusLabel = "Unknown";
     switch (status) {
@@ -57,10 +1032,57 @@ int main() {
     case pathcore::SearchStatus::NotStarted:
         statusLabel = "NotStarted";
         break;
+    case pathcore::SearchStatus::Cancelled:
+        statusLabel = "Cancelled";
+        break;
     }
 
     std::cout << "AStar status=" << statusLabel << " steps=" << steps
-              << " pathCount=" << pathCount << "\n";
+              << " pathLength=" << path.cells.size() << " pathCost=" << path.cost << "\n";
 
+    if (!checkRetarget()) {
+        std::cout << "Retarget check failed\n";
+        return 1;
+    }
+    if (!checkComponentUpkeep()) {
+        std::cout << "Component upkeep check failed\n";
+        return 1;
+    }
+    if (!checkPathDatabase()) {
+        std::cout << "Path database check failed\n";
+        return 1;
+    }
+    if (!checkDistanceFieldRepair()) {
+        std::cout << "Distance field check failed\n";
+        return 1;
+    }
+    if (!checkPathCache()) {
+        std::cout << "Path cache check failed\n";
+        return 1;
+    }
+    if (!checkBidirectionalOptimal()) {
+        std::cout << "Bidirectional check failed\n";
+        return 1;
+    }
+    if (!checkAnytimeBounds()) {
+        std::cout << "Anytime bound check failed\n";
+        return 1;
+    }
+    if (!checkRecorderReplay()) {
+        std::cout << "Recorder check failed\n";
+        return 1;
+    }
+    if (!checkContentHash()) {
+        std::cout << "Content hash check failed\n";
+        return 1;
+    }
+    if (!checkSchedulerBudgets()) {
+        std::cout << "Scheduler check failed\n";
+        return 1;
+    }
+    if (!checkWarmQueries()) {
+        std::cout << "Warm queries allocated\n";
+        return 1;
+    }
     return 0;
 }
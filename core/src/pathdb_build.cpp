@@ -0,0 +1,58 @@
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "pathcore/MapIO.h"
+#include "pathcore/PathDatabase.h"
+#include "pathcore/SearchConfig.h"
+
+namespace {
+
+void printUsage() {
+    std::cerr << "usage: pathdb_build <map.txt> <out.pathdb> [--eight] [--corner-cutting] [--weights]"
+                 " [--threads N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    pathcore::SearchConfig config;
+    int threads = 0;
+    for (int i = 3; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--eight") {
+            config.neighborMode = pathcore::NeighborMode::Eight;
+        } else if (arg == "--corner-cutting") {
+            config.allowCornerCutting = true;
+        } else if (arg == "--weights") {
+            config.useWeights = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    pathcore::MapIoError ioErr;
+    std::optional<pathcore::LoadedMap> loaded = pathcore::loadMapFromFile(argv[1], &ioErr);
+    if (!loaded) {
+        std::cerr << "Failed to load map: " << ioErr.message << "\n";
+        return 1;
+    }
+
+    pathcore::PathDatabaseError err;
+    if (!pathcore::buildPathDatabase(loaded->grid, config, argv[2], threads, &err)) {
+        std::cerr << "Failed to build path database: " << err.message << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << argv[2] << " for " << loaded->grid.width() << "x" << loaded->grid.height()
+              << " map\n";
+    return 0;
+}